@@ -48,11 +48,16 @@
 #include <errno.h>
 #endif
 
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+
 #ifndef PATH_MAX
 #define PATH_MAX 4096
 #endif
 
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <gdk/gdkkeysyms.h>
 
 #ifdef HAVE_THUNARX
@@ -75,8 +80,31 @@
 #include <libxfce4ui/libxfce4ui.h>
 
 #define SAVE_DELAY  1000
+/* the position journal is folded back into the rc file once it has
+ * more records than this, or than there are icons */
+#define JOURNAL_MIN_COMPACT  256
+#define JOURNAL_REMOVED      G_MAXUINT
+/* how long file monitor events are collected before they're handled */
+#define FILE_CHANGES_DELAY   100
+/* file info lookups kept in flight at once for those events */
+#define FILE_CHANGES_BATCH_SIZE  16
+/* metadata lookups kept in flight at once while refreshing */
+#define METADATA_BATCH_SIZE  16
+/* bounds for the number of files asked for at once while loading the
+ * desktop folder, and how long handling one batch may take */
+#define ENUMERATE_BATCH_MIN   16
+#define ENUMERATE_BATCH_MAX   4096
+#define ENUMERATE_BATCH_TIME  0.008
+
+#define SNAPSHOT_GROUP    "Desktop Snapshot"
+#define SNAPSHOT_VERSION  2
 #define BORDER         8
 
+/* how long (in seconds) process_icon_from_queue() may spend adding icons
+ * before giving the main loop a chance to paint them; half a frame at 60Hz */
+#define PENDING_ICONS_BUDGET  0.008
+#define PENDING_ICONS_CHUNK      16
+
 typedef enum
 {
     PROP0 = 0,
@@ -115,11 +143,27 @@ struct _XfdesktopFileIconManagerPrivate
     XfdesktopFileIcon *desktop_icon;
     GFileMonitor *monitor;
     GFileEnumerator *enumerator;
+    GCancellable *enumerator_cancellable;
+    gint enumerator_batch_size;
+    gboolean desktop_loaded;
+
+    /* icons shown from the last session's snapshot that the folder
+     * listing hasn't confirmed yet */
+    GHashTable *snapshot_icons;
+
+    /* file monitor events waiting to be handled in one go, see
+     * xfdesktop_file_icon_manager_queue_file_change() */
+    GHashTable *file_changes;
+    GList *pending_file_changes;
+    guint file_changes_id;
+    gboolean file_changes_busy;
+    GCancellable *file_changes_cancellable;
 
     GVolumeMonitor *volume_monitor;
 
     GFileMonitor *metadata_monitor;
     guint metadata_timer;
+    GCancellable *metadata_cancellable;
 
     GHashTable *icons;
     GHashTable *removable_icons;
@@ -134,6 +178,27 @@ struct _XfdesktopFileIconManagerPrivate
     gboolean show_hidden_files;
     
     guint save_icons_id;
+
+    /* the workarea size picking the icon position file, updated when the
+     * icon view lays out its grid again */
+    gint workarea_width;
+    gint workarea_height;
+
+    /* the icon position file, parsed once instead of once per icon;
+     * maps group names to packed row/col pairs */
+    GHashTable *positions;
+    gchar *positions_relpath;
+    gchar *positions_filename;
+    time_t positions_mtime;
+    time_t positions_journal_mtime;
+    gboolean positions_have_identifiers;
+
+    /* position changes not yet written to the journal, with the same
+     * packing as positions, or JOURNAL_REMOVED */
+    GHashTable *journal_pending;
+    gchar *journal_path;
+    guint journal_records;
+    gboolean save_snapshot;
     
     GQueue *pending_icons;
     guint pending_icons_id;
@@ -161,6 +226,14 @@ static void xfdesktop_file_icon_manager_get_property(GObject *object,
                                                      GValue *value,
                                                      GParamSpec *pspec);
 static void xfdesktop_file_icon_manager_finalize(GObject *obj);
+static void xfdesktop_file_icon_manager_clear_positions(XfdesktopFileIconManager *fmanager);
+static void xfdesktop_file_icon_manager_load_positions(XfdesktopFileIconManager *fmanager);
+static void xfdesktop_file_icon_manager_cancel_file_changes(XfdesktopFileIconManager *fmanager);
+static gboolean xfdesktop_file_icon_manager_process_file_changes(gpointer user_data);
+static void xfdesktop_file_icon_manager_file_change_ready(GObject *source_object,
+                                                          GAsyncResult *result,
+                                                          gpointer user_data);
+static void xfdesktop_file_icon_manager_clear_snapshot_icons(XfdesktopFileIconManager *fmanager);
 static void xfdesktop_file_icon_manager_icon_view_manager_init(XfdesktopIconViewManagerIface *iface);
 
 static gboolean xfdesktop_file_icon_manager_real_init(XfdesktopIconViewManager *manager,
@@ -518,6 +591,11 @@ xfdesktop_file_icon_manager_finalize(GObject *obj)
     if(fmanager->priv->volume_monitor != NULL)
         g_object_unref(fmanager->priv->volume_monitor);
 
+    xfdesktop_file_icon_manager_clear_positions(fmanager);
+    if(fmanager->priv->journal_pending)
+        g_hash_table_destroy(fmanager->priv->journal_pending);
+    g_free(fmanager->priv->journal_path);
+
     G_OBJECT_CLASS(xfdesktop_file_icon_manager_parent_class)->finalize(obj);
 }
 
@@ -1888,6 +1966,251 @@ file_icon_hash_write_icons(gpointer key,
         g_free(identifier);
 }
 
+static void
+xfdesktop_file_icon_manager_apply_position(GHashTable *positions,
+                                           const gchar *name,
+                                           guint position)
+{
+    if(position == JOURNAL_REMOVED)
+        g_hash_table_remove(positions, name);
+    else
+        g_hash_table_replace(positions, g_strdup(name), GUINT_TO_POINTER(position));
+}
+
+/* Replays a position journal written by
+ * xfdesktop_file_icon_manager_append_journal() onto @positions.  Each
+ * line is "row col name" or "- name", with the name escaped; a last line
+ * without a newline was cut short by a crash and is ignored (the next
+ * append cuts it off, see xfdesktop_file_icon_manager_trim_journal()). */
+static void
+xfdesktop_file_icon_manager_read_journal(GHashTable *positions,
+                                         const gchar *journal_path)
+{
+    gchar *contents = NULL, *line, *end;
+    gsize length = 0;
+
+    if(!g_file_get_contents(journal_path, &contents, &length, NULL))
+        return;
+
+    for(line = contents; (end = memchr(line, '\n', contents + length - line)); line = end + 1) {
+        gchar *name, *p;
+        guint position;
+
+        *end = '\0';
+
+        if(line[0] == '-' && line[1] == ' ') {
+            position = JOURNAL_REMOVED;
+            p = line + 2;
+        } else {
+            gint64 row, col;
+
+            row = g_ascii_strtoll(line, &p, 10);
+            if(p == line || *p != ' ')
+                continue;
+            line = p + 1;
+            col = g_ascii_strtoll(line, &p, 10);
+            if(p == line || *p != ' '
+               || row < 0 || col < 0 || row > G_MAXINT16 || col > G_MAXINT16)
+            {
+                continue;
+            }
+            position = ((guint)row << 16) | (guint)col;
+            p++;
+        }
+
+        name = g_strcompress(p);
+        xfdesktop_file_icon_manager_apply_position(positions, name, position);
+        g_free(name);
+    }
+
+    g_free(contents);
+}
+
+/* Cuts a line that a crash left without its newline off the end of the
+ * journal open as @fd, so the next record doesn't get glued onto it. */
+static gboolean
+xfdesktop_file_icon_manager_trim_journal(gint fd)
+{
+    gchar buf[4096];
+    struct stat st;
+    off_t end;
+
+    if(fstat(fd, &st) < 0)
+        return FALSE;
+
+    end = st.st_size;
+    while(end > 0) {
+        gssize n, i;
+        gsize want = MIN((off_t)sizeof(buf), end);
+
+        n = pread(fd, buf, want, end - want);
+        if(n < 0) {
+            if(errno == EINTR)
+                continue;
+            return FALSE;
+        }
+        if(n != (gssize)want)
+            return FALSE;
+
+        for(i = n - 1; i >= 0; --i) {
+            if(buf[i] == '\n')
+                break;
+        }
+
+        if(i >= 0) {
+            end -= want - (i + 1);
+            break;
+        }
+
+        end -= want;
+    }
+
+    if(end == st.st_size)
+        return TRUE;
+
+    XF_DEBUG("dropping %ld bytes of a torn journal record", (glong)(st.st_size - end));
+
+    return ftruncate(fd, end) == 0;
+}
+
+/* Appends the pending position changes to the journal next to the rc
+ * file at @path and syncs it, so they survive a crash without the whole
+ * file being rewritten. */
+static gboolean
+xfdesktop_file_icon_manager_append_journal(XfdesktopFileIconManager *fmanager,
+                                           const gchar *path)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+    GString *records;
+    gchar *journal_path;
+    gboolean ret = TRUE;
+    gsize written = 0;
+    gint fd;
+
+    journal_path = g_strconcat(path, ".journal", NULL);
+    fd = open(journal_path, O_RDWR | O_APPEND | O_CREAT, 0666);
+    if(fd < 0) {
+        XF_DEBUG("unable to open %s: %s", journal_path, strerror(errno));
+        g_free(journal_path);
+        return FALSE;
+    }
+
+    if(!xfdesktop_file_icon_manager_trim_journal(fd)) {
+        g_warning("Unable to repair %s: %s", journal_path, strerror(errno));
+        close(fd);
+        g_free(journal_path);
+        return FALSE;
+    }
+
+    records = g_string_new(NULL);
+    g_hash_table_iter_init(&iter, fmanager->priv->journal_pending);
+    while(g_hash_table_iter_next(&iter, &key, &value)) {
+        gchar *escaped = g_strescape(key, NULL);
+        guint position = GPOINTER_TO_UINT(value);
+
+        if(position == JOURNAL_REMOVED)
+            g_string_append_printf(records, "- %s\n", escaped);
+        else
+            g_string_append_printf(records, "%u %u %s\n",
+                                   position >> 16, position & 0xffff, escaped);
+
+        g_free(escaped);
+    }
+
+    while(written < records->len) {
+        gssize n = write(fd, records->str + written, records->len - written);
+        if(n < 0) {
+            if(errno == EINTR)
+                continue;
+            g_warning("Unable to write to %s: %s", journal_path, strerror(errno));
+            ret = FALSE;
+            break;
+        }
+        written += n;
+    }
+
+    if(ret && fsync(fd) < 0) {
+        g_warning("Unable to sync %s: %s", journal_path, strerror(errno));
+        ret = FALSE;
+    }
+
+    close(fd);
+
+    if(ret) {
+        XF_DEBUG("appended %u records to %s",
+                 g_hash_table_size(fmanager->priv->journal_pending), journal_path);
+
+        fmanager->priv->journal_records += g_hash_table_size(fmanager->priv->journal_pending);
+
+        /* keep the in-memory copy of the file in step, rather than
+         * parsing it all again on the next lookup */
+        if(fmanager->priv->positions
+           && !g_strcmp0(fmanager->priv->positions_filename, path))
+        {
+            GStatBuf st;
+
+            g_hash_table_iter_init(&iter, fmanager->priv->journal_pending);
+            while(g_hash_table_iter_next(&iter, &key, &value)) {
+                xfdesktop_file_icon_manager_apply_position(fmanager->priv->positions,
+                                                           key,
+                                                           GPOINTER_TO_UINT(value));
+            }
+
+            if(g_stat(journal_path, &st) == 0)
+                fmanager->priv->positions_journal_mtime = st.st_mtime;
+        } else {
+            xfdesktop_file_icon_manager_clear_positions(fmanager);
+            xfdesktop_file_icon_manager_load_positions(fmanager);
+        }
+
+        g_hash_table_remove_all(fmanager->priv->journal_pending);
+    }
+
+    g_string_free(records, TRUE);
+    g_free(journal_path);
+
+    return ret;
+}
+
+/* Notes @icon's current position (or that it's gone, if @keep is FALSE)
+ * for the next save. */
+static void
+xfdesktop_file_icon_manager_journal_icon(XfdesktopFileIconManager *fmanager,
+                                         XfdesktopIcon *icon,
+                                         gboolean keep)
+{
+    gchar *identifier = xfdesktop_icon_get_identifier(icon);
+    const gchar *name = identifier ? identifier : xfdesktop_icon_peek_label(icon);
+    guint position = JOURNAL_REMOVED;
+    gint16 row, col;
+
+    if(!name) {
+        g_free(identifier);
+        return;
+    }
+
+    if(keep) {
+        if(!xfdesktop_icon_get_position(icon, &row, &col) || row < 0 || col < 0) {
+            g_free(identifier);
+            return;
+        }
+        position = ((guint)row << 16) | (guint)col;
+    }
+
+    if(!fmanager->priv->journal_pending) {
+        fmanager->priv->journal_pending = g_hash_table_new_full(g_str_hash,
+                                                                g_str_equal,
+                                                                g_free,
+                                                                NULL);
+    }
+
+    g_hash_table_replace(fmanager->priv->journal_pending,
+                         g_strdup(name), GUINT_TO_POINTER(position));
+
+    g_free(identifier);
+}
+
 static gboolean
 xfdesktop_file_icon_manager_save_icons(gpointer user_data)
 {
@@ -1914,6 +2237,21 @@ xfdesktop_file_icon_manager_save_icons(gpointer user_data)
     if(!path)
         return FALSE;
 
+    /* Moving a few icons around only appends to the journal; the whole
+     * file is rewritten when something asked for it, when the journal
+     * belongs to another file or when it has grown too long. */
+    if(!fmanager->priv->save_snapshot
+       && fmanager->priv->journal_pending
+       && !g_strcmp0(path, fmanager->priv->journal_path)
+       && fmanager->priv->journal_records + g_hash_table_size(fmanager->priv->journal_pending)
+          <= MAX(JOURNAL_MIN_COMPACT, g_hash_table_size(fmanager->priv->icons)))
+    {
+        if(xfdesktop_file_icon_manager_append_journal(fmanager, path)) {
+            g_free(path);
+            return FALSE;
+        }
+    }
+
     XF_DEBUG("saving to: %s", path);
 
     tmppath = g_strconcat(path, ".new", NULL);
@@ -1947,6 +2285,25 @@ xfdesktop_file_icon_manager_save_icons(gpointer user_data)
             g_warning("Unable to rename temp file to %s: %s", path,
                       strerror(errno));
             unlink(tmppath);
+        } else {
+            gchar *journal_path = g_strconcat(path, ".journal", NULL);
+
+            /* everything in the journal is in the new file now; if we
+             * crash before it's gone, replaying it again is harmless */
+            if(unlink(journal_path) && errno != ENOENT)
+                g_warning("Unable to remove %s: %s", journal_path, strerror(errno));
+            g_free(journal_path);
+
+            g_free(fmanager->priv->journal_path);
+            fmanager->priv->journal_path = g_strdup(path);
+            fmanager->priv->journal_records = 0;
+            fmanager->priv->save_snapshot = FALSE;
+            if(fmanager->priv->journal_pending)
+                g_hash_table_remove_all(fmanager->priv->journal_pending);
+
+            /* this may be a different file than the one that was read */
+            xfdesktop_file_icon_manager_clear_positions(fmanager);
+            xfdesktop_file_icon_manager_load_positions(fmanager);
         }
     } else {
         XF_DEBUG("didn't write anything in the RC file, desktop is probably empty");
@@ -1959,11 +2316,8 @@ xfdesktop_file_icon_manager_save_icons(gpointer user_data)
 }
 
 static void
-xfdesktop_file_icon_position_changed(XfdesktopFileIcon *icon,
-                                     gpointer user_data)
+xfdesktop_file_icon_manager_queue_save(XfdesktopFileIconManager *fmanager)
 {
-    XfdesktopFileIconManager *fmanager = XFDESKTOP_FILE_ICON_MANAGER(user_data);
-    
     if(fmanager->priv->save_icons_id)
         g_source_remove(fmanager->priv->save_icons_id);
     
@@ -1972,6 +2326,21 @@ xfdesktop_file_icon_position_changed(XfdesktopFileIcon *icon,
                                                   fmanager);
 }
 
+/* @icon is NULL when the positions of everything should be saved */
+static void
+xfdesktop_file_icon_position_changed(XfdesktopFileIcon *icon,
+                                     gpointer user_data)
+{
+    XfdesktopFileIconManager *fmanager = XFDESKTOP_FILE_ICON_MANAGER(user_data);
+
+    if(icon)
+        xfdesktop_file_icon_manager_journal_icon(fmanager, XFDESKTOP_ICON(icon), TRUE);
+    else
+        fmanager->priv->save_snapshot = TRUE;
+
+    xfdesktop_file_icon_manager_queue_save(fmanager);
+}
+
 
 /*   *****   */
 
@@ -1984,32 +2353,68 @@ xfdesktop_file_icon_save(gpointer user_data)
         xfdesktop_file_icon_position_changed(NULL, user_data);
 }
 
-gboolean
-xfdesktop_file_icon_manager_get_cached_icon_position(XfdesktopFileIconManager *fmanager,
-                                                     const gchar *name,
-                                                     const gchar *identifier,
-                                                     gint16 *row,
-                                                     gint16 *col)
+static void
+xfdesktop_file_icon_manager_clear_positions(XfdesktopFileIconManager *fmanager)
 {
-    gchar relpath[PATH_MAX];
-    gchar *filename = NULL;
-    gboolean ret = FALSE;
-    gint x = 0, y = 0, width = 0, height = 0;
+    if(fmanager->priv->positions) {
+        g_hash_table_destroy(fmanager->priv->positions);
+        fmanager->priv->positions = NULL;
+    }
 
-    if(!fmanager || !fmanager->priv)
-        return FALSE;
+    g_free(fmanager->priv->positions_relpath);
+    fmanager->priv->positions_relpath = NULL;
+    g_free(fmanager->priv->positions_filename);
+    fmanager->priv->positions_filename = NULL;
+    fmanager->priv->positions_mtime = 0;
+    fmanager->priv->positions_journal_mtime = 0;
+    fmanager->priv->positions_have_identifiers = FALSE;
+}
+
+/* Makes sure fmanager->priv->positions holds the contents of the position
+ * file for the last known workarea size.  The file is only parsed again
+ * when the workarea size changed, when we wrote it or when its mtime
+ * changed; this is checked once per load or relayout, not per icon. */
+static void
+xfdesktop_file_icon_manager_load_positions(XfdesktopFileIconManager *fmanager)
+{
+    gchar relpath[PATH_MAX];
+    gchar *filename;
+    gchar **groups;
+    XfceRc *rcfile;
+    GStatBuf st;
+    gint i;
 
-    xfdesktop_get_workarea_single(fmanager->priv->icon_view,
-                                  0,
-                                  &x,
-                                  &y,
-                                  &width,
-                                  &height);
-    
     g_snprintf(relpath, PATH_MAX, "xfce4/desktop/icons.screen%d-%dx%d.rc",
                0,
-               width,
-               height);
+               fmanager->priv->workarea_width,
+               fmanager->priv->workarea_height);
+
+    if(fmanager->priv->positions
+       && !g_strcmp0(relpath, fmanager->priv->positions_relpath))
+    {
+        /* no file was found last time, or it's the same file */
+        if(!fmanager->priv->positions_filename)
+            return;
+        if(g_stat(fmanager->priv->positions_filename, &st) == 0
+           && st.st_mtime == fmanager->priv->positions_mtime)
+        {
+            gchar *journal_path = g_strconcat(fmanager->priv->positions_filename,
+                                              ".journal", NULL);
+            time_t journal_mtime = 0;
+
+            if(g_stat(journal_path, &st) == 0)
+                journal_mtime = st.st_mtime;
+            g_free(journal_path);
+
+            if(journal_mtime == fmanager->priv->positions_journal_mtime)
+                return;
+        }
+    }
+
+    xfdesktop_file_icon_manager_clear_positions(fmanager);
+    fmanager->priv->positions = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                                      g_free, NULL);
+    fmanager->priv->positions_relpath = g_strdup(relpath);
 
     filename = xfce_resource_lookup(XFCE_RESOURCE_CONFIG, relpath);
 
@@ -2019,30 +2424,106 @@ xfdesktop_file_icon_manager_get_cached_icon_position(XfdesktopFileIconManager *f
         filename = xfce_resource_lookup(XFCE_RESOURCE_CONFIG, relpath);
     }
 
-    if(filename != NULL) {
-        XfceRc *rcfile;
-        const gchar *icon_name;
-        rcfile = xfce_rc_simple_open(filename, TRUE);
+    if(filename == NULL)
+        return;
+
+    if(g_stat(filename, &st) == 0)
+        fmanager->priv->positions_mtime = st.st_mtime;
+    fmanager->priv->positions_filename = filename;
 
-        /* Newer versions use the identifier rather than the icon label when
-         * possible */
-        if(xfce_rc_has_group(rcfile, XFDESKTOP_RC_VERSION_STAMP) && identifier)
-            icon_name = identifier;
-        else
-            icon_name = name;
-
-        if(xfce_rc_has_group(rcfile, icon_name)) {
-            xfce_rc_set_group(rcfile, icon_name);
-            *row = xfce_rc_read_int_entry(rcfile, "row", -1);
-            *col = xfce_rc_read_int_entry(rcfile, "col", -1);
-            if(*row >= 0 && *col >= 0)
-                ret = TRUE;
+    rcfile = xfce_rc_simple_open(filename, TRUE);
+    if(!rcfile)
+        return;
+
+    XF_DEBUG("loading icon positions from %s", filename);
+
+    /* Newer versions use the identifier rather than the icon label when
+     * possible */
+    fmanager->priv->positions_have_identifiers = xfce_rc_has_group(rcfile,
+                                                                   XFDESKTOP_RC_VERSION_STAMP);
+
+    groups = xfce_rc_get_groups(rcfile);
+    for(i = 0; groups && groups[i]; ++i) {
+        gint row, col;
+
+        xfce_rc_set_group(rcfile, groups[i]);
+        row = xfce_rc_read_int_entry(rcfile, "row", -1);
+        col = xfce_rc_read_int_entry(rcfile, "col", -1);
+        if(row < 0 || col < 0 || row > G_MAXINT16 || col > G_MAXINT16)
+            continue;
+
+        g_hash_table_replace(fmanager->priv->positions,
+                             g_strdup(groups[i]),
+                             GUINT_TO_POINTER(((guint)row << 16) | (guint)col));
+    }
+
+    g_strfreev(groups);
+    xfce_rc_close(rcfile);
+
+    /* only the current file format has a journal */
+    if(fmanager->priv->positions_have_identifiers) {
+        gchar *journal_path = g_strconcat(filename, ".journal", NULL);
+
+        if(g_stat(journal_path, &st) == 0) {
+            fmanager->priv->positions_journal_mtime = st.st_mtime;
+            xfdesktop_file_icon_manager_read_journal(fmanager->priv->positions,
+                                                     journal_path);
         }
-        xfce_rc_close(rcfile);
-        g_free(filename);
+
+        g_free(journal_path);
     }
-    
-    return ret;
+}
+
+/* Picks up the current workarea size and any change to the position file
+ * on disk.  Called when the desktop is (re)loaded and when the icon view
+ * was laid out again, so the lookups in between are plain hash lookups. */
+static void
+xfdesktop_file_icon_manager_refresh_positions(XfdesktopFileIconManager *fmanager)
+{
+    gint x = 0, y = 0, width = 0, height = 0;
+
+    xfdesktop_get_workarea_single(fmanager->priv->icon_view,
+                                  0,
+                                  &x,
+                                  &y,
+                                  &width,
+                                  &height);
+
+    fmanager->priv->workarea_width = width;
+    fmanager->priv->workarea_height = height;
+
+    xfdesktop_file_icon_manager_load_positions(fmanager);
+}
+
+gboolean
+xfdesktop_file_icon_manager_get_cached_icon_position(XfdesktopFileIconManager *fmanager,
+                                                     const gchar *name,
+                                                     const gchar *identifier,
+                                                     gint16 *row,
+                                                     gint16 *col)
+{
+    const gchar *icon_name;
+    gpointer position;
+
+    if(!fmanager || !fmanager->priv || !fmanager->priv->positions)
+        return FALSE;
+
+    if(fmanager->priv->positions_have_identifiers && identifier)
+        icon_name = identifier;
+    else
+        icon_name = name;
+
+    if(!icon_name
+       || !g_hash_table_lookup_extended(fmanager->priv->positions, icon_name,
+                                        NULL, &position))
+    {
+        return FALSE;
+    }
+
+    *row = GPOINTER_TO_UINT(position) >> 16;
+    *col = GPOINTER_TO_UINT(position) & 0xffff;
+
+    return TRUE;
 }
 
 
@@ -2083,37 +2564,77 @@ xfdesktop_file_icon_manager_queue_thumbnail(XfdesktopFileIconManager *fmanager,
 }
 
 static void
-add_icon_to_iconview(XfdesktopFileIconManager *fmanager,
-                     XfdesktopIcon *icon)
+prepare_icon_for_iconview(XfdesktopFileIconManager *fmanager,
+                          XfdesktopIcon *icon)
 {
-    /* Pay attention to position changes and add the icon to the icon view */
+    /* Pay attention to position changes */
     g_signal_connect(G_OBJECT(icon), "position-changed",
                      G_CALLBACK(xfdesktop_file_icon_position_changed),
                      fmanager);
 
-    /* Tell the icon view about the icon */
-    xfdesktop_icon_view_add_item(fmanager->priv->icon_view,
-                                 XFDESKTOP_ICON(icon));
-
 #if defined(DEBUG) && DEBUG > 0
     _alive_icon_list = g_list_prepend(_alive_icon_list, icon);
     g_object_weak_ref(G_OBJECT(icon), _icon_notify_destroy, NULL);
 #endif
 }
 
-/* Adds a single icon to the icon view, popping from the top of the stack.
- * Will continue to run until it runs out of icons to add at which point
- * it will free the queue and return FALSE */
+static void
+add_icon_to_iconview(XfdesktopFileIconManager *fmanager,
+                     XfdesktopIcon *icon)
+{
+    prepare_icon_for_iconview(fmanager, icon);
+
+    /* Tell the icon view about the icon */
+    xfdesktop_icon_view_add_item(fmanager->priv->icon_view,
+                                 XFDESKTOP_ICON(icon));
+}
+
+/* Adds icons to the icon view, popping from the top of the stack, in
+ * chunks until the per-frame time budget is used up.  Will continue to
+ * run until it runs out of icons to add at which point it will free the
+ * queue and return FALSE */
 static gboolean
 process_icon_from_queue(gpointer user_data)
 {
     XfdesktopFileIconManager *fmanager;
     XfdesktopFileIcon *icon;
+    GTimer *timer;
+    GList *batch;
+    gint n;
 
     g_return_val_if_fail(XFDESKTOP_IS_FILE_ICON_MANAGER(user_data), FALSE);
 
     fmanager = XFDESKTOP_FILE_ICON_MANAGER(user_data);
 
+    timer = g_timer_new();
+
+    while(!g_queue_is_empty(fmanager->priv->pending_icons)
+          && g_timer_elapsed(timer, NULL) < PENDING_ICONS_BUDGET)
+    {
+        batch = NULL;
+
+        for(n = 0; n < PENDING_ICONS_CHUNK; ++n) {
+            if(g_queue_is_empty(fmanager->priv->pending_icons))
+                break;
+
+            icon = g_queue_pop_head(fmanager->priv->pending_icons);
+
+            /* skip bad icons */
+            if(icon == NULL || !XFDESKTOP_IS_FILE_ICON(icon))
+                continue;
+
+            prepare_icon_for_iconview(fmanager, XFDESKTOP_ICON(icon));
+            batch = g_list_prepend(batch, icon);
+        }
+
+        batch = g_list_reverse(batch);
+        xfdesktop_icon_view_add_items(fmanager->priv->icon_view, batch);
+        g_list_free(batch);
+    }
+
+    XF_DEBUG("added icons for %.1fms", g_timer_elapsed(timer, NULL) * 1000);
+    g_timer_destroy(timer);
+
     /* Free our queue and return FALSE when we run out of items */
     if(g_queue_is_empty(fmanager->priv->pending_icons)) {
         g_queue_free(fmanager->priv->pending_icons);
@@ -2122,14 +2643,6 @@ process_icon_from_queue(gpointer user_data)
         return FALSE;
     }
 
-    icon = g_queue_pop_head(fmanager->priv->pending_icons);
-
-    /* skip bad icons */
-    if(icon == NULL || !XFDESKTOP_IS_FILE_ICON(icon))
-        return TRUE;
-
-    add_icon_to_iconview(fmanager, XFDESKTOP_ICON(icon));
-
     return TRUE;
 }
 
@@ -2150,6 +2663,9 @@ icon_view_resized(XfdesktopIconView *icon_view,
     if(!XFDESKTOP_IS_FILE_ICON_MANAGER(fmanager) || !XFDESKTOP_IS_ICON_VIEW(icon_view))
         return;
 
+    /* the workarea may have changed, and with it the position file */
+    xfdesktop_file_icon_manager_refresh_positions(fmanager);
+
     /* No pending icons, nothing to do */
     if(fmanager->priv->pending_icons == NULL || g_queue_is_empty(fmanager->priv->pending_icons))
         return;
@@ -2227,14 +2743,13 @@ xfdesktop_file_icon_manager_add_icon(XfdesktopFileIconManager *fmanager,
         XF_DEBUG("icon '%s' didn't have a previous position", name);
     }
 
-    if(fmanager->priv->pending_icons_id != 0)
-        g_source_remove(fmanager->priv->pending_icons_id);
-
     /* While xfdesktop is idle we'll add icons to the icon view */
-    fmanager->priv->pending_icons_id = g_idle_add_full(G_PRIORITY_LOW,
-                                                       process_icon_from_queue,
-                                                       fmanager,
-                                                       NULL);
+    if(fmanager->priv->pending_icons_id == 0) {
+        fmanager->priv->pending_icons_id = g_idle_add_full(G_PRIORITY_LOW,
+                                                           process_icon_from_queue,
+                                                           fmanager,
+                                                           NULL);
+    }
 
     if(identifier)
         g_free(identifier);
@@ -2278,19 +2793,24 @@ xfdesktop_file_icon_manager_remove_icon(XfdesktopFileIconManager *fmanager,
     g_hash_table_remove(fmanager->priv->icons, xfdesktop_file_icon_peek_file(icon));
 }
 
-/* If row and col are set then they will be used, otherwise set them to -1
- * and it will lookup the position in the rc file */
-static XfdesktopFileIcon *
-xfdesktop_file_icon_manager_add_regular_icon(XfdesktopFileIconManager *fmanager,
-                                             GFile *file,
-                                             GFileInfo *info,
-                                             gint16 row, gint16 col,
-                                             gboolean defer_if_missing)
+/* Whether @file shouldn't get an icon on the desktop: hidden and backup
+ * files, and desktop entries that are hidden from Xfce, unless hidden
+ * files are shown. */
+static gboolean
+xfdesktop_file_icon_manager_is_file_hidden(XfdesktopFileIconManager *fmanager,
+                                           GFile *file,
+                                           GFileInfo *info)
 {
-    XfdesktopRegularFileIcon *icon = NULL;
     gboolean is_desktop_file = FALSE;
-    
-    g_return_val_if_fail(fmanager && G_IS_FILE(file) && G_IS_FILE_INFO(info), NULL);
+
+    if(fmanager->priv->show_hidden_files)
+        return FALSE;
+
+    /* If it's a hidden or backup file don't show it on the desktop */
+    if(g_file_info_get_is_hidden(info) || g_file_info_get_is_backup(info)) {
+        XF_DEBUG("Not adding icon because it is either hidden or a backup file");
+        return TRUE;
+    }
 
     if(g_content_type_equals(g_file_info_get_content_type(info), 
                              "application/x-desktop")) 
@@ -2308,7 +2828,7 @@ xfdesktop_file_icon_manager_add_regular_icon(XfdesktopFileIconManager *fmanager,
     /* if it's a .desktop file, and it has Hidden=true, or an
      * OnlyShowIn Or NotShowIn that would hide it from Xfce, don't
      * show it on the desktop (bug #4022) */
-    if(is_desktop_file && !fmanager->priv->show_hidden_files)
+    if(is_desktop_file)
     {
         gchar *path = g_file_get_path(file);
         XfceRc *rcfile = xfce_rc_simple_open(path, TRUE);
@@ -2316,40 +2836,51 @@ xfdesktop_file_icon_manager_add_regular_icon(XfdesktopFileIconManager *fmanager,
 
         if(rcfile) {
             const gchar *value;
+            gboolean hidden = FALSE;
 
             xfce_rc_set_group(rcfile, "Desktop Entry");
             if(xfce_rc_read_bool_entry(rcfile, "Hidden", FALSE)) {
-                xfce_rc_close(rcfile);
                 XF_DEBUG("Not adding icon because it has the Hidden Desktop Entry set");
-                return NULL;
+                hidden = TRUE;
             }
 
             value = xfce_rc_read_entry(rcfile, "OnlyShowIn", NULL);
-            if(value && strncmp(value, "XFCE;", 5) && !strstr(value, ";XFCE;")) {
-                xfce_rc_close(rcfile);
+            if(!hidden && value && strncmp(value, "XFCE;", 5) && !strstr(value, ";XFCE;")) {
                 XF_DEBUG("Not adding icon because it has the OnlyShowIn Desktop Entry set");
-                return NULL;
+                hidden = TRUE;
             }
 
             value = xfce_rc_read_entry(rcfile, "NotShowIn", NULL);
-            if(value && (!strncmp(value, "XFCE;", 5) || strstr(value, ";XFCE;"))) {
-                xfce_rc_close(rcfile);
+            if(!hidden && value && (!strncmp(value, "XFCE;", 5) || strstr(value, ";XFCE;"))) {
                 XF_DEBUG("Not adding icon because it has the NotShowIn Desktop Entry set");
-                return NULL;
+                hidden = TRUE;
             }
 
             xfce_rc_close(rcfile);
-        }
-    }
 
-    /* If it's a hidden or backup file don't show it on the desktop */
-    if(g_file_info_get_is_hidden(info) || g_file_info_get_is_backup(info)) {
-        if(!fmanager->priv->show_hidden_files) {
-            XF_DEBUG("Not adding icon because it is either hidden or a backup file");
-            return NULL;
+            return hidden;
         }
     }
 
+    return FALSE;
+}
+
+/* If row and col are set then they will be used, otherwise set them to -1
+ * and it will lookup the position in the rc file */
+static XfdesktopFileIcon *
+xfdesktop_file_icon_manager_add_regular_icon(XfdesktopFileIconManager *fmanager,
+                                             GFile *file,
+                                             GFileInfo *info,
+                                             gint16 row, gint16 col,
+                                             gboolean defer_if_missing)
+{
+    XfdesktopRegularFileIcon *icon = NULL;
+    
+    g_return_val_if_fail(fmanager && G_IS_FILE(file) && G_IS_FILE_INFO(info), NULL);
+
+    if(xfdesktop_file_icon_manager_is_file_hidden(fmanager, file, info))
+        return NULL;
+
     /* should never return NULL */
     icon = xfdesktop_regular_file_icon_new(file, info, fmanager->priv->gscreen, fmanager);
     
@@ -2361,6 +2892,27 @@ xfdesktop_file_icon_manager_add_regular_icon(XfdesktopFileIconManager *fmanager,
     return XFDESKTOP_FILE_ICON(icon);
 }
 
+/* Puts an icon from the snapshot straight on the icon view.  It was
+ * visible when the snapshot was taken; whether it still should be, and
+ * its thumbnail, wait until the folder listing confirms it, so nothing
+ * here touches the disk. */
+static XfdesktopFileIcon *
+xfdesktop_file_icon_manager_add_snapshot_icon(XfdesktopFileIconManager *fmanager,
+                                              GFile *file,
+                                              GFileInfo *info,
+                                              gint16 row, gint16 col)
+{
+    XfdesktopRegularFileIcon *icon;
+
+    icon = xfdesktop_regular_file_icon_new(file, info, fmanager->priv->gscreen, fmanager);
+
+    xfdesktop_icon_set_position(XFDESKTOP_ICON(icon), row, col);
+    add_icon_to_iconview(fmanager, XFDESKTOP_ICON(icon));
+
+    g_hash_table_replace(fmanager->priv->icons, g_object_ref(file), icon);
+    return XFDESKTOP_FILE_ICON(icon);
+}
+
 static XfdesktopFileIcon *
 xfdesktop_file_icon_manager_add_volume_icon(XfdesktopFileIconManager *fmanager,
                                             GVolume *volume)
@@ -2458,6 +3010,9 @@ xfdesktop_file_icon_manager_refresh_icons(XfdesktopFileIconManager *fmanager)
         fmanager->priv->save_icons_id = 0;
         xfdesktop_file_icon_manager_save_icons(fmanager);
     }
+
+    /* everything is about to be listed again anyway */
+    xfdesktop_file_icon_manager_cancel_file_changes(fmanager);
     
     /* ditch removable media */
     if(fmanager->priv->show_removable_media)
@@ -2475,6 +3030,7 @@ xfdesktop_file_icon_manager_refresh_icons(XfdesktopFileIconManager *fmanager)
     }
 
     /* ditch normal icons */
+    xfdesktop_file_icon_manager_clear_snapshot_icons(fmanager);
     if(fmanager->priv->icons) {
         g_hash_table_foreach_remove(fmanager->priv->icons,
                                     (GHRFunc)xfdesktop_remove_icons_ht,
@@ -2500,6 +3056,7 @@ xfdesktop_file_icon_manager_refresh_icons(XfdesktopFileIconManager *fmanager)
         xfdesktop_file_icon_manager_load_removable_media(fmanager);
 
     /* reload and add ~/Desktop/ */
+    xfdesktop_file_icon_manager_refresh_positions(fmanager);
     xfdesktop_file_icon_manager_load_desktop_folder(fmanager);
 }
 
@@ -2591,6 +3148,315 @@ xfdesktop_file_icon_manager_key_press(GtkWidget *widget,
     return FALSE;
 }
 
+typedef enum
+{
+    XFDESKTOP_FILE_CHANGE_CREATED = 0,
+    XFDESKTOP_FILE_CHANGE_MOVED_IN,
+    XFDESKTOP_FILE_CHANGE_UPDATED,
+} XfdesktopFileChangeType;
+
+typedef struct _XfdesktopFileChangeBatch XfdesktopFileChangeBatch;
+
+typedef struct
+{
+    XfdesktopFileChangeBatch *batch;
+    /* its link in pending_file_changes until it's part of a batch */
+    GList *link;
+    XfdesktopFileChangeType type;
+    GFile *file;
+    GFileInfo *info;
+    /* where a moved icon was */
+    gint16 row, col;
+    /* set when a later event made this one pointless */
+    gboolean stale;
+} XfdesktopFileChange;
+
+struct _XfdesktopFileChangeBatch
+{
+    XfdesktopFileIconManager *fmanager;
+    GCancellable *cancellable;
+    GList *changes;
+    /* the first change whose lookup hasn't been started */
+    GList *next;
+    guint n_outstanding;
+};
+
+static void
+xfdesktop_file_change_free(gpointer data)
+{
+    XfdesktopFileChange *change = data;
+
+    g_object_unref(change->file);
+    if(change->info)
+        g_object_unref(change->info);
+    g_slice_free(XfdesktopFileChange, change);
+}
+
+/* Forgets whatever is queued or being looked up for @file, because it
+ * was deleted or moved away, or because a newer event replaces it. */
+static void
+xfdesktop_file_icon_manager_drop_file_change(XfdesktopFileIconManager *fmanager,
+                                             GFile *file)
+{
+    XfdesktopFileChange *change;
+
+    if(!fmanager->priv->file_changes)
+        return;
+
+    change = g_hash_table_lookup(fmanager->priv->file_changes, file);
+    if(!change)
+        return;
+
+    g_hash_table_remove(fmanager->priv->file_changes, file);
+
+    if(change->batch) {
+        /* its batch owns it; it's skipped there */
+        change->stale = TRUE;
+    } else {
+        fmanager->priv->pending_file_changes = g_list_delete_link(fmanager->priv->pending_file_changes,
+                                                                  change->link);
+        xfdesktop_file_change_free(change);
+    }
+}
+
+static void
+xfdesktop_file_icon_manager_apply_file_change(XfdesktopFileIconManager *fmanager,
+                                              XfdesktopFileChange *change)
+{
+    XfdesktopFileIcon *icon;
+
+    icon = g_hash_table_lookup(fmanager->priv->icons, change->file);
+
+    switch(change->type) {
+        case XFDESKTOP_FILE_CHANGE_CREATED:
+        case XFDESKTOP_FILE_CHANGE_MOVED_IN:
+            /* first make sure we don't already have an icon for this path.
+             * this seems to be necessary to avoid inconsistencies */
+            if(icon)
+                xfdesktop_file_icon_manager_remove_icon(fmanager, icon);
+
+            if(!change->info)
+                break;
+
+            if(change->type == XFDESKTOP_FILE_CHANGE_CREATED) {
+                xfdesktop_file_icon_manager_add_regular_icon(fmanager,
+                                                             change->file,
+                                                             change->info,
+                                                             -1, -1,
+                                                             TRUE);
+            } else {
+                /* Add the icon adding the row/col info */
+                icon = xfdesktop_file_icon_manager_add_regular_icon(fmanager,
+                                                                    change->file,
+                                                                    change->info,
+                                                                    change->row,
+                                                                    change->col,
+                                                                    FALSE);
+                if(icon)
+                    xfdesktop_file_icon_position_changed(icon, fmanager);
+            }
+            break;
+
+        case XFDESKTOP_FILE_CHANGE_UPDATED:
+            if(!icon)
+                break;
+
+            if(change->info) {
+                /* update the icon if the file still exists */
+                xfdesktop_file_icon_update_file_info(icon, change->info);
+            } else {
+                /* Remove the icon as it doesn't seem to exist */
+                xfdesktop_file_icon_manager_remove_icon(fmanager, icon);
+            }
+            break;
+    }
+}
+
+/* Starts lookups for the batch's next changes, so that no more than
+ * FILE_CHANGES_BATCH_SIZE of them are in flight at once. */
+static void
+xfdesktop_file_change_batch_query_more(XfdesktopFileChangeBatch *batch)
+{
+    while(batch->next && batch->n_outstanding < FILE_CHANGES_BATCH_SIZE) {
+        XfdesktopFileChange *change = batch->next->data;
+
+        batch->next = batch->next->next;
+
+        /* dropped while it waited for its turn */
+        if(change->stale)
+            continue;
+
+        batch->n_outstanding++;
+        g_file_query_info_async(change->file, XFDESKTOP_FILE_INFO_NAMESPACE,
+                                G_FILE_QUERY_INFO_NONE, G_PRIORITY_DEFAULT,
+                                batch->cancellable,
+                                xfdesktop_file_icon_manager_file_change_ready,
+                                change);
+    }
+}
+
+/* Applies the changes of a batch that has all its lookups done, frees it,
+ * and moves on to whatever was queued in the meantime. */
+static void
+xfdesktop_file_change_batch_finish(XfdesktopFileChangeBatch *batch)
+{
+    XfdesktopFileIconManager *fmanager = batch->fmanager;
+    GList *l;
+
+    /* the manager may be gone if this was cancelled */
+    if(!g_cancellable_is_cancelled(batch->cancellable)) {
+        XF_DEBUG("handling %u file changes", g_list_length(batch->changes));
+
+        for(l = batch->changes; l; l = l->next) {
+            XfdesktopFileChange *change = l->data;
+
+            if(change->stale)
+                continue;
+
+            if(g_hash_table_lookup(fmanager->priv->file_changes, change->file) == change)
+                g_hash_table_remove(fmanager->priv->file_changes, change->file);
+
+            xfdesktop_file_icon_manager_apply_file_change(fmanager, change);
+        }
+
+        fmanager->priv->file_changes_busy = FALSE;
+        if(fmanager->priv->pending_file_changes && !fmanager->priv->file_changes_id)
+            xfdesktop_file_icon_manager_process_file_changes(fmanager);
+    }
+
+    g_list_free_full(batch->changes, xfdesktop_file_change_free);
+    g_object_unref(batch->cancellable);
+    g_slice_free(XfdesktopFileChangeBatch, batch);
+}
+
+static void
+xfdesktop_file_icon_manager_file_change_ready(GObject *source_object,
+                                              GAsyncResult *result,
+                                              gpointer user_data)
+{
+    XfdesktopFileChange *change = user_data;
+    XfdesktopFileChangeBatch *batch = change->batch;
+
+    change->info = g_file_query_info_finish(G_FILE(source_object), result, NULL);
+    batch->n_outstanding--;
+
+    if(!g_cancellable_is_cancelled(batch->cancellable))
+        xfdesktop_file_change_batch_query_more(batch);
+
+    if(batch->n_outstanding == 0)
+        xfdesktop_file_change_batch_finish(batch);
+}
+
+/* Looks up the file info for everything queued since the timer started,
+ * without blocking and a few files at a time, and applies the results
+ * together once they're all in.  Only one batch runs at once; events
+ * that come in meanwhile make up the next one. */
+static gboolean
+xfdesktop_file_icon_manager_process_file_changes(gpointer user_data)
+{
+    XfdesktopFileIconManager *fmanager = XFDESKTOP_FILE_ICON_MANAGER(user_data);
+    XfdesktopFileChangeBatch *batch;
+    GList *l;
+
+    fmanager->priv->file_changes_id = 0;
+
+    if(!fmanager->priv->pending_file_changes || fmanager->priv->file_changes_busy)
+        return FALSE;
+
+    if(!fmanager->priv->file_changes_cancellable)
+        fmanager->priv->file_changes_cancellable = g_cancellable_new();
+
+    batch = g_slice_new0(XfdesktopFileChangeBatch);
+    batch->fmanager = fmanager;
+    batch->cancellable = g_object_ref(fmanager->priv->file_changes_cancellable);
+    batch->changes = g_list_reverse(fmanager->priv->pending_file_changes);
+    batch->next = batch->changes;
+    fmanager->priv->pending_file_changes = NULL;
+    fmanager->priv->file_changes_busy = TRUE;
+
+    for(l = batch->changes; l; l = l->next)
+        ((XfdesktopFileChange *)l->data)->batch = batch;
+
+    xfdesktop_file_change_batch_query_more(batch);
+
+    return FALSE;
+}
+
+static void
+xfdesktop_file_icon_manager_queue_file_change(XfdesktopFileIconManager *fmanager,
+                                              XfdesktopFileChangeType type,
+                                              GFile *file,
+                                              gint16 row,
+                                              gint16 col)
+{
+    XfdesktopFileChange *change;
+
+    if(!fmanager->priv->file_changes) {
+        fmanager->priv->file_changes = g_hash_table_new(g_file_hash,
+                                                        (GEqualFunc)g_file_equal);
+    }
+
+    change = g_hash_table_lookup(fmanager->priv->file_changes, file);
+    if(change) {
+        if(type == XFDESKTOP_FILE_CHANGE_UPDATED) {
+            /* a lookup that hasn't started yet will see this change too */
+            if(!change->batch)
+                return;
+
+            /* the icon may not exist yet, so redo the whole thing */
+            type = change->type;
+            row = change->row;
+            col = change->col;
+        }
+
+        xfdesktop_file_icon_manager_drop_file_change(fmanager, file);
+    }
+
+    change = g_slice_new0(XfdesktopFileChange);
+    change->type = type;
+    change->file = g_object_ref(file);
+    change->row = row;
+    change->col = col;
+
+    g_hash_table_insert(fmanager->priv->file_changes, change->file, change);
+    fmanager->priv->pending_file_changes = g_list_prepend(fmanager->priv->pending_file_changes,
+                                                          change);
+    change->link = fmanager->priv->pending_file_changes;
+
+    /* the window isn't extended by later events, so a steady stream of
+     * them still gets handled every FILE_CHANGES_DELAY */
+    if(!fmanager->priv->file_changes_id) {
+        fmanager->priv->file_changes_id = g_timeout_add(FILE_CHANGES_DELAY,
+                                                        xfdesktop_file_icon_manager_process_file_changes,
+                                                        fmanager);
+    }
+}
+
+static void
+xfdesktop_file_icon_manager_cancel_file_changes(XfdesktopFileIconManager *fmanager)
+{
+    if(fmanager->priv->file_changes_id) {
+        g_source_remove(fmanager->priv->file_changes_id);
+        fmanager->priv->file_changes_id = 0;
+    }
+
+    /* batches that are still looking things up free themselves */
+    fmanager->priv->file_changes_busy = FALSE;
+    if(fmanager->priv->file_changes_cancellable) {
+        g_cancellable_cancel(fmanager->priv->file_changes_cancellable);
+        g_object_unref(fmanager->priv->file_changes_cancellable);
+        fmanager->priv->file_changes_cancellable = NULL;
+    }
+
+    g_list_free_full(fmanager->priv->pending_file_changes, xfdesktop_file_change_free);
+    fmanager->priv->pending_file_changes = NULL;
+
+    if(fmanager->priv->file_changes) {
+        g_hash_table_destroy(fmanager->priv->file_changes);
+        fmanager->priv->file_changes = NULL;
+    }
+}
+
 static void
 xfdesktop_file_icon_manager_file_changed(GFileMonitor     *monitor,
                                          GFile            *file,
@@ -2600,18 +3466,20 @@ xfdesktop_file_icon_manager_file_changed(GFileMonitor     *monitor,
 {
     XfdesktopFileIconManager *fmanager = XFDESKTOP_FILE_ICON_MANAGER(user_data);
     XfdesktopFileIcon *icon, *moved_icon;
-    GFileInfo *file_info;
     gint16 row = 0, col = 0;
     gchar *filename;
 
+    /* Anything that needs the file's info is queued, so that a burst of
+     * events (say, from extracting an archive onto the desktop) costs one
+     * batch of asynchronous lookups rather than a blocking stat each.
+     * Removals don't need any I/O and are handled right away. */
     switch(event) {
         case G_FILE_MONITOR_EVENT_MOVED:
             XF_DEBUG("got a moved event");
 
-            icon = g_hash_table_lookup(fmanager->priv->icons, file);
+            xfdesktop_file_icon_manager_drop_file_change(fmanager, file);
 
-            file_info = g_file_query_info(other_file, XFDESKTOP_FILE_INFO_NAMESPACE,
-                                          G_FILE_QUERY_INFO_NONE, NULL, NULL);
+            icon = g_hash_table_lookup(fmanager->priv->icons, file);
 
             if(icon) {
                 /* Get the old position so we can use it for the new icon */
@@ -2644,43 +3512,26 @@ xfdesktop_file_icon_manager_file_changed(GFileMonitor     *monitor,
             if(xfdesktop_compare_paths(g_file_get_parent(other_file), fmanager->priv->folder)) {
                 XF_DEBUG("icon moved off the desktop");
                 /* Nothing moved, this is actually a delete */
-                if(file_info)
-                    g_object_unref(file_info);
-
+                xfdesktop_file_icon_manager_drop_file_change(fmanager, other_file);
                 return;
             }
 
-            if(file_info) {
-                /* Add the icon adding the row/col info */
-                icon = xfdesktop_file_icon_manager_add_regular_icon(fmanager,
-                                                                    other_file,
-                                                                    file_info,
-                                                                    row,
-                                                                    col,
-                                                                    FALSE);
-                if(icon)
-                    xfdesktop_file_icon_position_changed(icon, fmanager);
-
-                g_object_unref(file_info);
-            }
+            xfdesktop_file_icon_manager_queue_file_change(fmanager,
+                                                          XFDESKTOP_FILE_CHANGE_MOVED_IN,
+                                                          other_file, row, col);
             break;
         case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
         case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
             XF_DEBUG("got changed event");
 
-            icon = g_hash_table_lookup(fmanager->priv->icons, file);
-            if(icon) {
-                file_info = g_file_query_info(file, XFDESKTOP_FILE_INFO_NAMESPACE,
-                                              G_FILE_QUERY_INFO_NONE, NULL, NULL);
-
-                if(file_info) {
-                    /* update the icon if the file still exists */
-                    xfdesktop_file_icon_update_file_info(icon, file_info);
-                    g_object_unref(file_info);
-                } else {
-                    /* Remove the icon as it doesn't seem to exist */
-                    xfdesktop_file_icon_manager_remove_icon(fmanager, icon);
-                }
+            /* files that are still being created are picked up by that */
+            if(g_hash_table_lookup(fmanager->priv->icons, file)
+               || (fmanager->priv->file_changes
+                   && g_hash_table_lookup(fmanager->priv->file_changes, file)))
+            {
+                xfdesktop_file_icon_manager_queue_file_change(fmanager,
+                                                              XFDESKTOP_FILE_CHANGE_UPDATED,
+                                                              file, -1, -1);
             }
             break;
         case G_FILE_MONITOR_EVENT_CREATED:
@@ -2690,34 +3541,25 @@ xfdesktop_file_icon_manager_file_changed(GFileMonitor     *monitor,
             if(g_file_equal(fmanager->priv->folder, file))
                 return;
 
-            /* first make sure we don't already have an icon for this path.
-             * this seems to be necessary to avoid inconsistencies */
-            icon = g_hash_table_lookup(fmanager->priv->icons, file);
-            if(icon) {
-                /* Remove the old icon */
-                xfdesktop_file_icon_manager_remove_icon(fmanager, icon);
-            }
-            
-            file_info = g_file_query_info(file, XFDESKTOP_FILE_INFO_NAMESPACE,
-                                          G_FILE_QUERY_INFO_NONE, NULL, NULL);
-            if(file_info) {
-                xfdesktop_file_icon_manager_add_regular_icon(fmanager,
-                                                             file, file_info,
-                                                             -1, -1,
-                                                             TRUE);
-
-                g_object_unref(file_info);
-            }
+            xfdesktop_file_icon_manager_queue_file_change(fmanager,
+                                                          XFDESKTOP_FILE_CHANGE_CREATED,
+                                                          file, -1, -1);
             break;
         case G_FILE_MONITOR_EVENT_DELETED:
             XF_DEBUG("got deleted event");
 
+            xfdesktop_file_icon_manager_drop_file_change(fmanager, file);
+
             filename = g_file_get_path(file);
 
             icon = g_hash_table_lookup(fmanager->priv->icons, file);
             if(icon) {
                 GList *item = NULL;
 
+                xfdesktop_file_icon_manager_journal_icon(fmanager,
+                                                         XFDESKTOP_ICON(icon),
+                                                         FALSE);
+
                 /* find out if the icon was pending creation */
                 if(fmanager->priv->pending_icons)
                     item = g_queue_find(fmanager->priv->pending_icons, icon);
@@ -2743,7 +3585,7 @@ xfdesktop_file_icon_manager_file_changed(GFileMonitor     *monitor,
                 /* always remove from the hash table */
                 g_hash_table_remove(fmanager->priv->icons, file);
 
-                xfdesktop_file_icon_position_changed(NULL, fmanager);
+                xfdesktop_file_icon_manager_queue_save(fmanager);
             } else {
                 if(g_file_equal(file, fmanager->priv->folder)) {
                     XF_DEBUG("~/Desktop disappeared!");
@@ -2762,37 +3604,202 @@ xfdesktop_file_icon_manager_file_changed(GFileMonitor     *monitor,
     }
 }
 
+typedef struct
+{
+    XfdesktopFileIconManager *fmanager;
+    GCancellable *cancellable;
+    GList *files;
+    guint n_outstanding;
+} XfdesktopMetadataRefresh;
+
+/* whether @a and @b have the same metadata:: attributes with the same
+ * values, in whatever order */
+static gboolean
+xfdesktop_file_icon_manager_metadata_equal(GFileInfo *a,
+                                           GFileInfo *b)
+{
+    gchar **a_attributes, **b_attributes;
+    gboolean equal;
+    gint i;
+
+    a_attributes = g_file_info_list_attributes(a, "metadata");
+    b_attributes = g_file_info_list_attributes(b, "metadata");
+
+    equal = g_strv_length(a_attributes) == g_strv_length(b_attributes);
+
+    for(i = 0; equal && a_attributes[i]; ++i) {
+        gchar *a_value, *b_value;
+
+        if(!g_file_info_has_attribute(b, a_attributes[i])) {
+            equal = FALSE;
+            break;
+        }
+
+        a_value = g_file_info_get_attribute_as_string(a, a_attributes[i]);
+        b_value = g_file_info_get_attribute_as_string(b, a_attributes[i]);
+        equal = g_strcmp0(a_value, b_value) == 0;
+        g_free(a_value);
+        g_free(b_value);
+    }
+
+    g_strfreev(a_attributes);
+    g_strfreev(b_attributes);
+
+    return equal;
+}
+
+/* returns a copy of @info with its metadata replaced by @metadata's */
+static GFileInfo *
+xfdesktop_file_icon_manager_merge_metadata(GFileInfo *info,
+                                           GFileInfo *metadata)
+{
+    GFileInfo *merged = g_file_info_copy(info);
+    gchar **attributes;
+    gint i;
+
+    attributes = g_file_info_list_attributes(merged, "metadata");
+    for(i = 0; attributes && attributes[i]; ++i)
+        g_file_info_remove_attribute(merged, attributes[i]);
+    g_strfreev(attributes);
+
+    attributes = g_file_info_list_attributes(metadata, "metadata");
+    for(i = 0; attributes && attributes[i]; ++i) {
+        GFileAttributeType type;
+        gpointer value;
+
+        if(g_file_info_get_attribute_data(metadata, attributes[i],
+                                          &type, &value, NULL))
+        {
+            g_file_info_set_attribute(merged, attributes[i], type, value);
+        }
+    }
+    g_strfreev(attributes);
+
+    return merged;
+}
+
+static void xfdesktop_file_icon_manager_refresh_next_metadata(XfdesktopMetadataRefresh *refresh);
+
 static void
-xfdesktop_file_icon_manager_update_file_info(gpointer key,
-                                             gpointer value,
-                                             gpointer user_data)
+xfdesktop_file_icon_manager_metadata_ready(GObject *source_object,
+                                           GAsyncResult *result,
+                                           gpointer user_data)
 {
-    XfdesktopFileIcon *icon = XFDESKTOP_FILE_ICON(value);
-    GFileInfo *file_info;
+    XfdesktopMetadataRefresh *refresh = user_data;
+    XfdesktopFileIconManager *fmanager = refresh->fmanager;
+    XfdesktopFileIcon *icon;
+    GFileInfo *metadata, *info;
+
+    metadata = g_file_query_info_finish(G_FILE(source_object), result, NULL);
+    refresh->n_outstanding--;
+
+    /* the manager may be gone if this was cancelled */
+    if(g_cancellable_is_cancelled(refresh->cancellable)) {
+        if(metadata)
+            g_object_unref(metadata);
+        if(refresh->n_outstanding == 0) {
+            g_list_free_full(refresh->files, g_object_unref);
+            g_object_unref(refresh->cancellable);
+            g_slice_free(XfdesktopMetadataRefresh, refresh);
+        }
+        return;
+    }
 
-    if(icon) {
-        file_info = g_file_query_info(key, XFDESKTOP_FILE_INFO_NAMESPACE,
-                                      G_FILE_QUERY_INFO_NONE, NULL, NULL);
+    icon = g_hash_table_lookup(fmanager->priv->icons, source_object);
+    if(icon && metadata) {
+        info = xfdesktop_file_icon_peek_file_info(icon);
+
+        /* most of the time, whatever changed wasn't about this file, and
+         * there's nothing to update or repaint */
+        if(!info) {
+            XF_DEBUG("no file info yet for %s", xfdesktop_icon_peek_label(XFDESKTOP_ICON(icon)));
+        } else if(!xfdesktop_file_icon_manager_metadata_equal(info, metadata)) {
+            XF_DEBUG("metadata changed for %s", xfdesktop_icon_peek_label(XFDESKTOP_ICON(icon)));
+
+            info = xfdesktop_file_icon_manager_merge_metadata(info, metadata);
+            xfdesktop_file_icon_update_file_info(icon, info);
+            g_object_unref(info);
+        }
+    }
+
+    if(metadata)
+        g_object_unref(metadata);
+
+    xfdesktop_file_icon_manager_refresh_next_metadata(refresh);
+}
+
+/* keeps up to METADATA_BATCH_SIZE lookups going until all the files
+ * have been looked at */
+static void
+xfdesktop_file_icon_manager_refresh_next_metadata(XfdesktopMetadataRefresh *refresh)
+{
+    while(refresh->files && refresh->n_outstanding < METADATA_BATCH_SIZE) {
+        GFile *file = refresh->files->data;
+
+        refresh->files = g_list_delete_link(refresh->files, refresh->files);
+        refresh->n_outstanding++;
+
+        g_file_query_info_async(file, "metadata::*",
+                                G_FILE_QUERY_INFO_NONE, G_PRIORITY_LOW,
+                                refresh->cancellable,
+                                xfdesktop_file_icon_manager_metadata_ready,
+                                refresh);
+        g_object_unref(file);
+    }
 
-        if(file_info) {
-            /* update the icon if the file still exists */
-            xfdesktop_file_icon_update_file_info(icon, file_info);
-            g_object_unref(file_info);
+    if(refresh->n_outstanding == 0) {
+        XF_DEBUG("metadata refresh done");
+
+        if(refresh->fmanager->priv->metadata_cancellable == refresh->cancellable) {
+            g_object_unref(refresh->fmanager->priv->metadata_cancellable);
+            refresh->fmanager->priv->metadata_cancellable = NULL;
         }
+
+        g_object_unref(refresh->cancellable);
+        g_slice_free(XfdesktopMetadataRefresh, refresh);
+    }
+}
+
+static void
+xfdesktop_file_icon_manager_cancel_metadata_refresh(XfdesktopFileIconManager *fmanager)
+{
+    if(fmanager->priv->metadata_cancellable) {
+        g_cancellable_cancel(fmanager->priv->metadata_cancellable);
+        g_object_unref(fmanager->priv->metadata_cancellable);
+        fmanager->priv->metadata_cancellable = NULL;
     }
 }
 
+/* Something changed in the gvfs metadata store, but it doesn't say what
+ * or for which file.  Look at just the metadata of every icon, without
+ * blocking, and only update the ones where it's actually different. */
 static gboolean
 xfdesktop_file_icon_manager_metadata_timer(gpointer user_data)
 {
     XfdesktopFileIconManager *fmanager = XFDESKTOP_FILE_ICON_MANAGER(user_data);
-
-    g_hash_table_foreach(fmanager->priv->icons,
-                         (GHFunc)xfdesktop_file_icon_manager_update_file_info,
-                         fmanager);
+    XfdesktopMetadataRefresh *refresh;
+    GList *files, *l;
 
     fmanager->priv->metadata_timer = 0;
 
+    /* anything still being looked at is looked at again */
+    xfdesktop_file_icon_manager_cancel_metadata_refresh(fmanager);
+
+    files = g_hash_table_get_keys(fmanager->priv->icons);
+    if(!files)
+        return FALSE;
+    for(l = files; l; l = l->next)
+        g_object_ref(l->data);
+
+    fmanager->priv->metadata_cancellable = g_cancellable_new();
+
+    refresh = g_slice_new0(XfdesktopMetadataRefresh);
+    refresh->fmanager = fmanager;
+    refresh->cancellable = g_object_ref(fmanager->priv->metadata_cancellable);
+    refresh->files = files;
+
+    xfdesktop_file_icon_manager_refresh_next_metadata(refresh);
+
     return FALSE;
 }
 
@@ -2832,6 +3839,386 @@ xfdesktop_file_icon_manager_metadata_changed(GFileMonitor     *monitor,
     fmanager->priv->metadata_timer = timer;
 }
 
+static gchar *
+xfdesktop_file_icon_manager_get_snapshot_path(XfdesktopFileIconManager *fmanager,
+                                              gboolean create)
+{
+    gchar relpath[PATH_MAX];
+    gint x = 0, y = 0, width = 0, height = 0;
+
+    xfdesktop_get_workarea_single(fmanager->priv->icon_view,
+                                  0,
+                                  &x,
+                                  &y,
+                                  &width,
+                                  &height);
+
+    g_snprintf(relpath, PATH_MAX, "xfce4/desktop/icons.screen%d-%dx%d.snapshot",
+               0,
+               width,
+               height);
+
+    return xfce_resource_save_location(XFCE_RESOURCE_CACHE, relpath, create);
+}
+
+/* Stores every attribute of @info under @group, as GVariant text so the
+ * types come back as they were; icons are stored serialized. */
+static void
+xfdesktop_file_icon_manager_save_snapshot_info(GKeyFile *key_file,
+                                               const gchar *group,
+                                               GFileInfo *info)
+{
+    gchar **attributes;
+    gint i;
+
+    attributes = g_file_info_list_attributes(info, NULL);
+    for(i = 0; attributes && attributes[i]; ++i) {
+        const gchar *attribute = attributes[i];
+        GVariant *variant = NULL;
+        gchar *text;
+
+        switch(g_file_info_get_attribute_type(info, attribute)) {
+            case G_FILE_ATTRIBUTE_TYPE_STRING: {
+                const gchar *string = g_file_info_get_attribute_string(info, attribute);
+                if(string && g_utf8_validate(string, -1, NULL))
+                    variant = g_variant_new_string(string);
+                break;
+            }
+            case G_FILE_ATTRIBUTE_TYPE_BYTE_STRING:
+                variant = g_variant_new_bytestring(g_file_info_get_attribute_byte_string(info, attribute));
+                break;
+            case G_FILE_ATTRIBUTE_TYPE_BOOLEAN:
+                variant = g_variant_new_boolean(g_file_info_get_attribute_boolean(info, attribute));
+                break;
+            case G_FILE_ATTRIBUTE_TYPE_UINT32:
+                variant = g_variant_new_uint32(g_file_info_get_attribute_uint32(info, attribute));
+                break;
+            case G_FILE_ATTRIBUTE_TYPE_INT32:
+                variant = g_variant_new_int32(g_file_info_get_attribute_int32(info, attribute));
+                break;
+            case G_FILE_ATTRIBUTE_TYPE_UINT64:
+                variant = g_variant_new_uint64(g_file_info_get_attribute_uint64(info, attribute));
+                break;
+            case G_FILE_ATTRIBUTE_TYPE_INT64:
+                variant = g_variant_new_int64(g_file_info_get_attribute_int64(info, attribute));
+                break;
+            case G_FILE_ATTRIBUTE_TYPE_STRINGV:
+                variant = g_variant_new_strv((const gchar * const *)g_file_info_get_attribute_stringv(info, attribute), -1);
+                break;
+            case G_FILE_ATTRIBUTE_TYPE_OBJECT: {
+                GObject *object = g_file_info_get_attribute_object(info, attribute);
+
+                /* g_icon_serialize() doesn't return a floating ref */
+                if(G_IS_ICON(object)) {
+                    GVariant *serialized = g_icon_serialize(G_ICON(object));
+                    if(serialized) {
+                        variant = g_variant_new_variant(serialized);
+                        g_variant_unref(serialized);
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+
+        if(!variant)
+            continue;
+
+        g_variant_ref_sink(variant);
+        text = g_variant_print(variant, TRUE);
+        g_key_file_set_string(key_file, group, attribute, text);
+
+        g_free(text);
+        g_variant_unref(variant);
+    }
+
+    g_strfreev(attributes);
+}
+
+/* The reverse of xfdesktop_file_icon_manager_save_snapshot_info(); keys
+ * that aren't file attributes are skipped. */
+static GFileInfo *
+xfdesktop_file_icon_manager_load_snapshot_info(GKeyFile *key_file,
+                                               const gchar *group)
+{
+    GFileInfo *info;
+    gchar **keys;
+    gint i;
+
+    info = g_file_info_new();
+
+    keys = g_key_file_get_keys(key_file, group, NULL, NULL);
+    for(i = 0; keys && keys[i]; ++i) {
+        const gchar *attribute = keys[i];
+        GVariant *variant;
+        gchar *text;
+
+        if(!strstr(attribute, "::"))
+            continue;
+
+        text = g_key_file_get_string(key_file, group, attribute, NULL);
+        variant = text ? g_variant_parse(NULL, text, NULL, NULL, NULL) : NULL;
+        g_free(text);
+        if(!variant)
+            continue;
+
+        if(g_variant_is_of_type(variant, G_VARIANT_TYPE_STRING)) {
+            g_file_info_set_attribute_string(info, attribute,
+                                             g_variant_get_string(variant, NULL));
+        } else if(g_variant_is_of_type(variant, G_VARIANT_TYPE_BYTESTRING)) {
+            g_file_info_set_attribute_byte_string(info, attribute,
+                                                  g_variant_get_bytestring(variant));
+        } else if(g_variant_is_of_type(variant, G_VARIANT_TYPE_BOOLEAN)) {
+            g_file_info_set_attribute_boolean(info, attribute,
+                                              g_variant_get_boolean(variant));
+        } else if(g_variant_is_of_type(variant, G_VARIANT_TYPE_UINT32)) {
+            g_file_info_set_attribute_uint32(info, attribute,
+                                             g_variant_get_uint32(variant));
+        } else if(g_variant_is_of_type(variant, G_VARIANT_TYPE_INT32)) {
+            g_file_info_set_attribute_int32(info, attribute,
+                                            g_variant_get_int32(variant));
+        } else if(g_variant_is_of_type(variant, G_VARIANT_TYPE_UINT64)) {
+            g_file_info_set_attribute_uint64(info, attribute,
+                                             g_variant_get_uint64(variant));
+        } else if(g_variant_is_of_type(variant, G_VARIANT_TYPE_INT64)) {
+            g_file_info_set_attribute_int64(info, attribute,
+                                            g_variant_get_int64(variant));
+        } else if(g_variant_is_of_type(variant, G_VARIANT_TYPE_STRING_ARRAY)) {
+            gchar **strv = g_variant_dup_strv(variant, NULL);
+            g_file_info_set_attribute_stringv(info, attribute, strv);
+            g_strfreev(strv);
+        } else if(g_variant_is_of_type(variant, G_VARIANT_TYPE_VARIANT)) {
+            GVariant *serialized = g_variant_get_variant(variant);
+            GIcon *gicon = g_icon_deserialize(serialized);
+
+            if(gicon) {
+                g_file_info_set_attribute_object(info, attribute, G_OBJECT(gicon));
+                g_object_unref(gicon);
+            }
+            g_variant_unref(serialized);
+        }
+
+        g_variant_unref(variant);
+    }
+
+    g_strfreev(keys);
+
+    return info;
+}
+
+/* Writes out what's needed to show the desktop's icons at the next login
+ * before the folder has been listed: the icons' whole file info, so that
+ * everything that reads it (menus, tooltips, drag and drop) sees the same
+ * as for an icon from the folder listing, and where they are. */
+static void
+xfdesktop_file_icon_manager_save_snapshot(XfdesktopFileIconManager *fmanager)
+{
+    GKeyFile *key_file;
+    GHashTableIter iter;
+    gpointer key, value;
+    gchar *path;
+    GError *error = NULL;
+
+    path = xfdesktop_file_icon_manager_get_snapshot_path(fmanager, TRUE);
+    if(!path)
+        return;
+
+    key_file = g_key_file_new();
+    g_key_file_set_integer(key_file, SNAPSHOT_GROUP, "Version", SNAPSHOT_VERSION);
+
+    g_hash_table_iter_init(&iter, fmanager->priv->icons);
+    while(g_hash_table_iter_next(&iter, &key, &value)) {
+        GFileInfo *info;
+        gchar *uri;
+        gint16 row, col;
+
+        if(!XFDESKTOP_IS_REGULAR_FILE_ICON(value))
+            continue;
+
+        info = xfdesktop_file_icon_peek_file_info(XFDESKTOP_FILE_ICON(value));
+        if(!info || !xfdesktop_icon_get_position(XFDESKTOP_ICON(value), &row, &col))
+            continue;
+
+        /* keyed by URI, as those can't contain brackets */
+        uri = g_file_get_uri(key);
+
+        xfdesktop_file_icon_manager_save_snapshot_info(key_file, uri, info);
+        g_key_file_set_integer(key_file, uri, "Row", row);
+        g_key_file_set_integer(key_file, uri, "Col", col);
+
+        g_free(uri);
+    }
+
+    if(!g_key_file_save_to_file(key_file, path, &error)) {
+        g_warning("Unable to save the desktop snapshot to %s: %s", path, error->message);
+        g_error_free(error);
+    } else
+        XF_DEBUG("saved desktop snapshot to %s", path);
+
+    g_key_file_free(key_file);
+    g_free(path);
+}
+
+/* Puts the icons from the last session's snapshot on the desktop right
+ * away, at their old positions, so that a login doesn't have to wait for
+ * the desktop folder to be listed.  The listing then reconciles them
+ * with what's actually there. */
+static void
+xfdesktop_file_icon_manager_restore_snapshot(XfdesktopFileIconManager *fmanager)
+{
+    GKeyFile *key_file;
+    gchar *path, **groups;
+    gint i;
+
+    path = xfdesktop_file_icon_manager_get_snapshot_path(fmanager, FALSE);
+    if(!path)
+        return;
+
+    key_file = g_key_file_new();
+    if(!g_key_file_load_from_file(key_file, path, G_KEY_FILE_NONE, NULL)
+       || g_key_file_get_integer(key_file, SNAPSHOT_GROUP, "Version", NULL) != SNAPSHOT_VERSION)
+    {
+        g_key_file_free(key_file);
+        g_free(path);
+        return;
+    }
+
+    XF_DEBUG("restoring desktop snapshot from %s", path);
+
+    if(!fmanager->priv->snapshot_icons) {
+        fmanager->priv->snapshot_icons = g_hash_table_new_full((GHashFunc)g_file_hash,
+                                                               (GEqualFunc)g_file_equal,
+                                                               (GDestroyNotify)g_object_unref,
+                                                               (GDestroyNotify)g_object_unref);
+    }
+
+    groups = g_key_file_get_groups(key_file, NULL);
+    for(i = 0; groups[i]; ++i) {
+        XfdesktopFileIcon *icon;
+        GFileInfo *info;
+        GFile *file;
+        gint row, col;
+
+        if(!g_strcmp0(groups[i], SNAPSHOT_GROUP))
+            continue;
+
+        /* only what's still in the same desktop folder, and isn't there
+         * already */
+        file = g_file_new_for_uri(groups[i]);
+        if(!g_file_has_parent(file, fmanager->priv->folder)
+           || g_hash_table_lookup(fmanager->priv->icons, file))
+        {
+            g_object_unref(file);
+            continue;
+        }
+
+        row = g_key_file_get_integer(key_file, groups[i], "Row", NULL);
+        col = g_key_file_get_integer(key_file, groups[i], "Col", NULL);
+        info = xfdesktop_file_icon_manager_load_snapshot_info(key_file, groups[i]);
+
+        if(row < 0 || col < 0
+           || !g_file_info_get_name(info)
+           || !g_file_info_get_display_name(info))
+        {
+            g_object_unref(info);
+            g_object_unref(file);
+            continue;
+        }
+
+        icon = xfdesktop_file_icon_manager_add_snapshot_icon(fmanager, file, info,
+                                                             row, col);
+        g_hash_table_replace(fmanager->priv->snapshot_icons, g_object_ref(file),
+                             g_object_ref(icon));
+
+        g_object_unref(info);
+        g_object_unref(file);
+    }
+
+    XF_DEBUG("restored %u icons", g_hash_table_size(fmanager->priv->snapshot_icons));
+
+    g_strfreev(groups);
+    g_key_file_free(key_file);
+    g_free(path);
+}
+
+/* If @file's icon came from the snapshot, gives it the real @info and
+ * returns TRUE; otherwise the caller should add an icon as usual.  The
+ * checks and the thumbnail that restoring left out happen here. */
+static gboolean
+xfdesktop_file_icon_manager_reconcile_snapshot_icon(XfdesktopFileIconManager *fmanager,
+                                                    GFile *file,
+                                                    GFileInfo *info)
+{
+    XfdesktopFileIcon *snapshot_icon, *icon;
+
+    if(!fmanager->priv->snapshot_icons)
+        return FALSE;
+
+    snapshot_icon = g_hash_table_lookup(fmanager->priv->snapshot_icons, file);
+    if(!snapshot_icon)
+        return FALSE;
+
+    /* hidden in the meantime; it gets removed with the leftovers */
+    if(xfdesktop_file_icon_manager_is_file_hidden(fmanager, file, info))
+        return TRUE;
+
+    icon = g_hash_table_lookup(fmanager->priv->icons, file);
+    if(icon == snapshot_icon) {
+        xfdesktop_file_icon_update_file_info(icon, info);
+        xfdesktop_file_icon_manager_queue_thumbnail(fmanager, icon);
+    }
+
+    g_hash_table_remove(fmanager->priv->snapshot_icons, file);
+
+    /* if the file monitor already replaced it there's nothing to do */
+    return icon != NULL;
+}
+
+static void
+xfdesktop_file_icon_manager_remove_snapshot_icons(XfdesktopFileIconManager *fmanager)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+
+    if(!fmanager->priv->snapshot_icons)
+        return;
+
+    g_hash_table_iter_init(&iter, fmanager->priv->snapshot_icons);
+    while(g_hash_table_iter_next(&iter, &key, &value)) {
+        if(g_hash_table_lookup(fmanager->priv->icons, key) == value) {
+            XF_DEBUG("%s is gone", xfdesktop_icon_peek_label(XFDESKTOP_ICON(value)));
+            xfdesktop_file_icon_manager_remove_icon(fmanager, value);
+        }
+    }
+
+    xfdesktop_file_icon_manager_clear_snapshot_icons(fmanager);
+}
+
+static void
+xfdesktop_file_icon_manager_clear_snapshot_icons(XfdesktopFileIconManager *fmanager)
+{
+    if(fmanager->priv->snapshot_icons) {
+        g_hash_table_destroy(fmanager->priv->snapshot_icons);
+        fmanager->priv->snapshot_icons = NULL;
+    }
+}
+
+static void
+xfdesktop_file_icon_manager_cancel_enumerator(XfdesktopFileIconManager *fmanager)
+{
+    if(fmanager->priv->enumerator_cancellable) {
+        g_cancellable_cancel(fmanager->priv->enumerator_cancellable);
+        g_object_unref(fmanager->priv->enumerator_cancellable);
+        fmanager->priv->enumerator_cancellable = NULL;
+    }
+
+    if(fmanager->priv->enumerator) {
+        g_object_unref(fmanager->priv->enumerator);
+        fmanager->priv->enumerator = NULL;
+    }
+}
+
 static void
 xfdesktop_file_icon_manager_files_ready(GFileEnumerator *enumerator,
                                         GAsyncResult *result,
@@ -2840,17 +4227,32 @@ xfdesktop_file_icon_manager_files_ready(GFileEnumerator *enumerator,
     XfdesktopFileIconManager *fmanager;
     GError *error = NULL;
     GList *files, *l;
+    GTimer *timer;
+    gdouble elapsed;
+    guint n_files = 0;
+
+    files = g_file_enumerator_next_files_finish(enumerator, result, &error);
+
+    /* the manager may be gone if this was cancelled */
+    if(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        g_error_free(error);
+        return;
+    }
 
     /* Sanity check */
-    if(user_data == NULL || !XFDESKTOP_IS_FILE_ICON_MANAGER(user_data))
+    if(user_data == NULL || !XFDESKTOP_IS_FILE_ICON_MANAGER(user_data)) {
+        g_list_free_full(files, g_object_unref);
+        g_clear_error(&error);
         return;
+    }
 
     fmanager = XFDESKTOP_FILE_ICON_MANAGER(user_data);
 
-    if(enumerator != fmanager->priv->enumerator)
+    if(enumerator != fmanager->priv->enumerator) {
+        g_list_free_full(files, g_object_unref);
+        g_clear_error(&error);
         return;
-
-    files = g_file_enumerator_next_files_finish(enumerator, result, &error);
+    }
 
     if(!files) {
         if(error) {
@@ -2862,10 +4264,17 @@ xfdesktop_file_icon_manager_files_ready(GFileEnumerator *enumerator,
                                 _("Failed to load the desktop folder"), error->message,
                                 XFCE_BUTTON_TYPE_MIXED, "window-close", _("_Close"), GTK_RESPONSE_ACCEPT,
                                 NULL);
+            g_error_free(error);
         }
 
         g_object_unref(fmanager->priv->enumerator);
         fmanager->priv->enumerator = NULL;
+        g_object_unref(fmanager->priv->enumerator_cancellable);
+        fmanager->priv->enumerator_cancellable = NULL;
+
+        /* whatever the listing didn't turn up is gone now */
+        xfdesktop_file_icon_manager_remove_snapshot_icons(fmanager);
+        fmanager->priv->desktop_loaded = TRUE;
 
         /* initialize the file monitor */
         if(!fmanager->priv->monitor) {
@@ -2899,52 +4308,110 @@ xfdesktop_file_icon_manager_files_ready(GFileEnumerator *enumerator,
             g_free(location);
         }
     } else {
+        timer = g_timer_new();
+
+        /* all of these go on the pending queue, which hands them to the
+         * icon view in bulk */
         for(l = files; l; l = l->next) {
             const gchar *name = g_file_info_get_name(l->data);
             GFile *file = g_file_get_child(fmanager->priv->folder, name);
 
             XF_DEBUG("got a GFileInfo: %s", g_file_info_get_display_name(l->data));
 
-            xfdesktop_file_icon_manager_add_regular_icon(fmanager,
-                                                         file, l->data,
-                                                         -1, -1,
-                                                         TRUE);
+            if(!xfdesktop_file_icon_manager_reconcile_snapshot_icon(fmanager, file, l->data)) {
+                xfdesktop_file_icon_manager_add_regular_icon(fmanager,
+                                                             file, l->data,
+                                                             -1, -1,
+                                                             TRUE);
+            }
 
             g_object_unref(file);
 
             g_object_unref(l->data);
+            n_files++;
         }
 
         g_list_free(files);
 
+        /* Ask for as many files at once as can be handled within
+         * ENUMERATE_BATCH_TIME, so a big folder doesn't take thousands of
+         * round trips, nor does one batch stall the main loop. */
+        elapsed = g_timer_elapsed(timer, NULL);
+        g_timer_destroy(timer);
+
+        if(n_files == (guint)fmanager->priv->enumerator_batch_size
+           && elapsed < ENUMERATE_BATCH_TIME / 2)
+        {
+            fmanager->priv->enumerator_batch_size = MIN(fmanager->priv->enumerator_batch_size * 2,
+                                                        ENUMERATE_BATCH_MAX);
+        } else if(elapsed > ENUMERATE_BATCH_TIME) {
+            fmanager->priv->enumerator_batch_size = MAX(fmanager->priv->enumerator_batch_size / 2,
+                                                        ENUMERATE_BATCH_MIN);
+        }
+
+        XF_DEBUG("handled %u files in %.1fms, asking for %d next",
+                 n_files, elapsed * 1000, fmanager->priv->enumerator_batch_size);
+
         g_file_enumerator_next_files_async(fmanager->priv->enumerator,
-                                           10, G_PRIORITY_DEFAULT, NULL,
+                                           fmanager->priv->enumerator_batch_size,
+                                           G_PRIORITY_DEFAULT,
+                                           fmanager->priv->enumerator_cancellable,
                                            (GAsyncReadyCallback) xfdesktop_file_icon_manager_files_ready,
                                            fmanager);
     }
 }
 
 static void
-xfdesktop_file_icon_manager_load_desktop_folder(XfdesktopFileIconManager *fmanager)
+xfdesktop_file_icon_manager_enumerate_ready(GObject *source_object,
+                                            GAsyncResult *result,
+                                            gpointer user_data)
 {
-    
-    if(fmanager->priv->enumerator) {
-        g_object_unref(fmanager->priv->enumerator);
-        fmanager->priv->enumerator = NULL;
-    }
+    XfdesktopFileIconManager *fmanager;
+    GFileEnumerator *enumerator;
+    GError *error = NULL;
 
-    fmanager->priv->enumerator = g_file_enumerate_children(fmanager->priv->folder,
-                                                           XFDESKTOP_FILE_INFO_NAMESPACE,
-                                                           G_FILE_QUERY_INFO_NONE,
-                                                           NULL, NULL);
+    enumerator = g_file_enumerate_children_finish(G_FILE(source_object), result, &error);
 
-    if(fmanager->priv->enumerator) {
-        g_file_enumerator_next_files_async(fmanager->priv->enumerator,
-                                           10, G_PRIORITY_DEFAULT, NULL,
-                                           (GAsyncReadyCallback) xfdesktop_file_icon_manager_files_ready,
-                                           fmanager);
+    /* the manager may be gone if this was cancelled */
+    if(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        g_error_free(error);
+        return;
+    }
 
+    fmanager = XFDESKTOP_FILE_ICON_MANAGER(user_data);
+
+    if(!enumerator) {
+        XF_DEBUG("unable to list the desktop folder: %s", error->message);
+        g_error_free(error);
+        return;
     }
+
+    fmanager->priv->enumerator = enumerator;
+    g_file_enumerator_next_files_async(fmanager->priv->enumerator,
+                                       fmanager->priv->enumerator_batch_size,
+                                       G_PRIORITY_DEFAULT,
+                                       fmanager->priv->enumerator_cancellable,
+                                       (GAsyncReadyCallback) xfdesktop_file_icon_manager_files_ready,
+                                       fmanager);
+}
+
+static void
+xfdesktop_file_icon_manager_load_desktop_folder(XfdesktopFileIconManager *fmanager)
+{
+    
+    xfdesktop_file_icon_manager_cancel_enumerator(fmanager);
+
+    fmanager->priv->enumerator_cancellable = g_cancellable_new();
+    fmanager->priv->enumerator_batch_size = ENUMERATE_BATCH_MIN;
+    fmanager->priv->desktop_loaded = FALSE;
+
+    g_file_enumerate_children_async(fmanager->priv->folder,
+                                    XFDESKTOP_FILE_INFO_NAMESPACE,
+                                    G_FILE_QUERY_INFO_NONE,
+                                    G_PRIORITY_DEFAULT,
+                                    fmanager->priv->enumerator_cancellable,
+                                    xfdesktop_file_icon_manager_enumerate_ready,
+                                    fmanager);
 }
 
 static void
@@ -3147,7 +4614,10 @@ xfdesktop_file_icon_manager_real_init(XfdesktopIconViewManager *manager,
     if(!xfdesktop_file_utils_dbus_init())
         g_warning("Unable to initialise D-Bus.  Some xfdesktop features may be unavailable.");
     
+    xfdesktop_file_icon_manager_refresh_positions(fmanager);
+
     /* do this in the reverse order stuff should be displayed */
+    xfdesktop_file_icon_manager_restore_snapshot(fmanager);
     xfdesktop_file_icon_manager_load_desktop_folder(fmanager);
     if(fmanager->priv->show_removable_media)
         xfdesktop_file_icon_manager_load_removable_media(fmanager);
@@ -3198,11 +4668,14 @@ xfdesktop_file_icon_manager_fini(XfdesktopIconViewManager *manager)
     }
 
     fmanager->priv->inited = FALSE;
+
+    /* a desktop that hasn't finished loading would make a partial
+     * snapshot */
+    if(fmanager->priv->desktop_loaded)
+        xfdesktop_file_icon_manager_save_snapshot(fmanager);
     
-    if(fmanager->priv->enumerator) {
-        g_object_unref(fmanager->priv->enumerator);
-        fmanager->priv->enumerator = NULL;
-    }
+    xfdesktop_file_icon_manager_cancel_enumerator(fmanager);
+    xfdesktop_file_icon_manager_clear_snapshot_icons(fmanager);
 
     g_signal_handlers_disconnect_by_func(G_OBJECT(fmanager->priv->icon_view),
                                          G_CALLBACK(icon_view_resized),
@@ -3264,6 +4737,7 @@ xfdesktop_file_icon_manager_fini(XfdesktopIconViewManager *manager)
         g_object_unref(fmanager->priv->monitor);
         fmanager->priv->monitor = NULL;
     }
+    xfdesktop_file_icon_manager_cancel_file_changes(fmanager);
 
     /* Same for the file metadata monitor */
     if(fmanager->priv->metadata_monitor) {
@@ -3275,6 +4749,7 @@ xfdesktop_file_icon_manager_fini(XfdesktopIconViewManager *manager)
     }
 
     /* remove any pending metadata changes */
+    xfdesktop_file_icon_manager_cancel_metadata_refresh(fmanager);
     if(fmanager->priv->metadata_timer != 0) {
         g_source_remove(fmanager->priv->metadata_timer);
         fmanager->priv->metadata_timer = 0;
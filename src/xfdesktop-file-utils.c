@@ -366,68 +366,85 @@ xfdesktop_file_utils_get_fallback_icon(gint size)
     return g_object_ref(G_OBJECT(xfdesktop_fallback_icon));
 }
 
-GdkPixbuf *
-xfdesktop_file_utils_get_icon(GIcon *icon,
-                              gint width,
-                              gint height,
-                              guint opacity)
+/* looks up and loads a themed icon; main thread only, like anything
+ * touching the icon theme.  @width and @height are logical pixels, the
+ * pixbuf returned is @scale times that. */
+static GdkPixbuf *
+xfdesktop_file_utils_load_themed_icon(GIcon *base_icon,
+                                      gint width,
+                                      gint height,
+                                      gint scale)
 {
     GtkIconTheme *itheme = gtk_icon_theme_get_default();
     GdkPixbuf *pix_theme = NULL, *pix = NULL;
-    GIcon *base_icon = NULL;
-    gint size = MIN(width, height);
+    GtkIconInfo *icon_info;
+
+    /* this picks the theme's HiDPI variants where there are any, rather
+     * than whatever happens to be closest to the device pixel size */
+    icon_info = gtk_icon_theme_lookup_by_gicon_for_scale(itheme, base_icon,
+                                                         MIN(width, height),
+                                                         scale,
+                                                         ITHEME_FLAGS);
+    if(icon_info) {
+        pix_theme = gtk_icon_info_load_icon(icon_info, NULL);
+        g_object_unref(icon_info);
+    }
 
-    g_return_val_if_fail(width > 0 && height > 0 && icon != NULL, NULL);
+    if(pix_theme) {
+        GdkPixbuf *tmp;
+        /* we can't edit thsese icons */
+        tmp = gdk_pixbuf_copy(pix_theme);
 
-    /* Extract the base icon if available */
-    if(G_IS_EMBLEMED_ICON(icon))
-        base_icon = g_emblemed_icon_get_icon(G_EMBLEMED_ICON(icon));
-    else
-        base_icon = icon;
+        /* ensure icons are within our size requirements since
+         * gtk_icon_theme_lookup_by_gicon isn't exact */
+        pix = exo_gdk_pixbuf_scale_down(tmp, TRUE, width * scale, height * scale);
 
-    if(!base_icon)
-        return NULL;
+        g_object_unref(G_OBJECT(tmp));
+        g_object_unref(G_OBJECT(pix_theme));
+        pix_theme = tmp = NULL;
+    }
 
-    if(G_IS_THEMED_ICON(base_icon)) {
-      GtkIconInfo *icon_info = gtk_icon_theme_lookup_by_gicon(itheme,
-                                                              base_icon, size,
-                                                              ITHEME_FLAGS);
-      if(icon_info) {
-          pix_theme = gtk_icon_info_load_icon(icon_info, NULL);
-          g_object_unref(icon_info);
-      }
-    } else if(G_IS_LOADABLE_ICON(base_icon)) {
+    return pix;
+}
+
+/* loads a loadable or file icon; this doesn't touch gtk, so it's safe to
+ * call from a worker thread */
+static GdkPixbuf *
+xfdesktop_file_utils_load_icon_data(GIcon *base_icon,
+                                    gint width,
+                                    gint height,
+                                    GCancellable *cancellable)
+{
+    GdkPixbuf *pix = NULL;
+
+    if(G_IS_LOADABLE_ICON(base_icon)) {
         GInputStream *stream = g_loadable_icon_load(G_LOADABLE_ICON(base_icon),
-                                                    size, NULL, NULL, NULL);
+                                                    MIN(width, height), NULL,
+                                                    cancellable, NULL);
         if(stream) {
-            pix = gdk_pixbuf_new_from_stream_at_scale(stream, width, height, TRUE, NULL, NULL);
+            pix = gdk_pixbuf_new_from_stream_at_scale(stream, width, height, TRUE,
+                                                      cancellable, NULL);
             g_object_unref(stream);
         }
     } else if(G_IS_FILE_ICON(base_icon)) {
-        GFile *file = g_file_icon_get_file(G_FILE_ICON(icon));
+        GFile *file = g_file_icon_get_file(G_FILE_ICON(base_icon));
         gchar *path = g_file_get_path(file);
 
         pix = gdk_pixbuf_new_from_file_at_size(path, width, height, NULL);
 
         g_free(path);
-        g_object_unref(file);
     }
 
+    return pix;
+}
 
-    if(pix_theme) {
-        GdkPixbuf *tmp;
-        /* we can't edit thsese icons */
-        tmp = gdk_pixbuf_copy(pix_theme);
-
-        /* ensure icons are within our size requirements since
-         * gtk_icon_theme_lookup_by_gicon isn't exact */
-        pix = exo_gdk_pixbuf_scale_down(tmp, TRUE, width, height);
-
-        g_object_unref(G_OBJECT(tmp));
-        g_object_unref(G_OBJECT(pix_theme));
-        pix_theme = tmp = NULL;
-    }
-
+/* adds the fallback, emblems and opacity to a freshly loaded @pix */
+static GdkPixbuf *
+xfdesktop_file_utils_finish_icon(GIcon *icon,
+                                 GdkPixbuf *pix,
+                                 gint size,
+                                 guint opacity)
+{
     /* fallback */
     if(G_UNLIKELY(!pix))
         pix = xfdesktop_file_utils_get_fallback_icon(size);
@@ -439,8 +456,15 @@ xfdesktop_file_utils_get_icon(GIcon *icon,
     }
 
     /* Add the emblems */
-    if(G_IS_EMBLEMED_ICON(icon))
+    if(G_IS_EMBLEMED_ICON(icon)) {
+        /* the fallback icon is shared, don't draw on it */
+        if(pix == xfdesktop_fallback_icon) {
+            GdkPixbuf *tmp = gdk_pixbuf_copy(pix);
+            g_object_unref(G_OBJECT(pix));
+            pix = tmp;
+        }
         xfdesktop_file_utils_add_emblems(pix, g_emblemed_icon_get_emblems(G_EMBLEMED_ICON(icon)));
+    }
 
     if(opacity != 100) {
         GdkPixbuf *tmp = exo_gdk_pixbuf_lucent(pix, opacity);
@@ -451,22 +475,391 @@ xfdesktop_file_utils_get_icon(GIcon *icon,
     return pix;
 }
 
+/* Rendered themed icons, shared between every icon showing the same
+ * GIcon (with the same emblems) at the same size, scale and opacity.
+ * The pixbufs handed out from here must not be modified. */
+#define ICON_CACHE_MAX_ENTRIES  512
+
+typedef struct
+{
+    GIcon *icon;
+    gint width;
+    gint height;
+    gint scale;
+    guint opacity;
+} XfdesktopIconCacheKey;
+
+static GHashTable *xfdesktop_icon_cache = NULL;
+
+/* scaled emblems by "icon@size", and everything drawn on top of an
+ * icon by "icon|icon|...@widthxheight" */
+static GHashTable *xfdesktop_emblem_cache = NULL;
+static GHashTable *xfdesktop_emblem_overlay_cache = NULL;
+
+static guint
+xfdesktop_icon_cache_key_hash(gconstpointer data)
+{
+    const XfdesktopIconCacheKey *key = data;
+
+    return g_icon_hash((gpointer)key->icon)
+           ^ (key->width << 20) ^ (key->height << 10)
+           ^ (key->scale << 4) ^ key->opacity;
+}
+
+static gboolean
+xfdesktop_icon_cache_key_equal(gconstpointer a,
+                               gconstpointer b)
+{
+    const XfdesktopIconCacheKey *key_a = a, *key_b = b;
+
+    return key_a->width == key_b->width
+           && key_a->height == key_b->height
+           && key_a->scale == key_b->scale
+           && key_a->opacity == key_b->opacity
+           && g_icon_equal(key_a->icon, key_b->icon);
+}
+
 static void
-xfdesktop_file_utils_add_emblems(GdkPixbuf *pix, GList *emblems)
+xfdesktop_icon_cache_key_free(gpointer data)
+{
+    XfdesktopIconCacheKey *key = data;
+
+    g_object_unref(key->icon);
+    g_slice_free(XfdesktopIconCacheKey, key);
+}
+
+static void
+xfdesktop_file_utils_icon_theme_changed(GtkIconTheme *itheme,
+                                        gpointer user_data)
+{
+    XF_DEBUG("icon theme changed, dropping %u cached icons",
+             g_hash_table_size(xfdesktop_icon_cache));
+
+    g_hash_table_remove_all(xfdesktop_icon_cache);
+    g_hash_table_remove_all(xfdesktop_emblem_cache);
+    g_hash_table_remove_all(xfdesktop_emblem_overlay_cache);
+}
+
+static void
+xfdesktop_file_utils_init_icon_caches(void)
+{
+    if(G_LIKELY(xfdesktop_icon_cache))
+        return;
+
+    xfdesktop_icon_cache = g_hash_table_new_full(xfdesktop_icon_cache_key_hash,
+                                                 xfdesktop_icon_cache_key_equal,
+                                                 xfdesktop_icon_cache_key_free,
+                                                 g_object_unref);
+    xfdesktop_emblem_cache = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                                   g_free, g_object_unref);
+    xfdesktop_emblem_overlay_cache = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                                           g_free, g_object_unref);
+
+    g_signal_connect(G_OBJECT(gtk_icon_theme_get_default()), "changed",
+                     G_CALLBACK(xfdesktop_file_utils_icon_theme_changed),
+                     NULL);
+}
+
+static GdkPixbuf *
+xfdesktop_file_utils_lookup_cached_icon(GIcon *icon,
+                                        gint width,
+                                        gint height,
+                                        gint scale,
+                                        guint opacity)
+{
+    XfdesktopIconCacheKey key = { icon, width, height, scale, opacity };
+    GdkPixbuf *pix;
+
+    if(!xfdesktop_icon_cache)
+        return NULL;
+
+    pix = g_hash_table_lookup(xfdesktop_icon_cache, &key);
+
+    return pix ? g_object_ref(G_OBJECT(pix)) : NULL;
+}
+
+static void
+xfdesktop_file_utils_cache_icon(GIcon *icon,
+                                gint width,
+                                gint height,
+                                gint scale,
+                                guint opacity,
+                                GdkPixbuf *pix)
+{
+    XfdesktopIconCacheKey *key;
+
+    if(!pix)
+        return;
+
+    xfdesktop_file_utils_init_icon_caches();
+
+    /* there's rarely more than a few dozen distinct icons on a desktop,
+     * but icon size changes would otherwise keep adding to it */
+    if(g_hash_table_size(xfdesktop_icon_cache) >= ICON_CACHE_MAX_ENTRIES)
+        g_hash_table_remove_all(xfdesktop_icon_cache);
+
+    key = g_slice_new(XfdesktopIconCacheKey);
+    key->icon = g_object_ref(icon);
+    key->width = width;
+    key->height = height;
+    key->scale = scale;
+    key->opacity = opacity;
+
+    g_hash_table_replace(xfdesktop_icon_cache, key, g_object_ref(G_OBJECT(pix)));
+}
+
+static GIcon *
+xfdesktop_file_utils_get_base_icon(GIcon *icon)
+{
+    /* Extract the base icon if available */
+    if(G_IS_EMBLEMED_ICON(icon))
+        return g_emblemed_icon_get_icon(G_EMBLEMED_ICON(icon));
+    else
+        return icon;
+}
+
+GdkPixbuf *
+xfdesktop_file_utils_get_icon(GIcon *icon,
+                              gint width,
+                              gint height,
+                              guint opacity)
+{
+    return xfdesktop_file_utils_get_icon_for_scale(icon, width, height, 1, opacity);
+}
+
+/* Loads @icon for a @width by @height logical pixel area on an output
+ * with a device scale of @scale; the pixbuf is in device pixels, so it's
+ * @scale times the size xfdesktop_file_utils_get_icon() would return.
+ * Themed icons are shared through a cache, so treat the result as
+ * read-only. */
+GdkPixbuf *
+xfdesktop_file_utils_get_icon_for_scale(GIcon *icon,
+                                        gint width,
+                                        gint height,
+                                        gint scale,
+                                        guint opacity)
+{
+    GdkPixbuf *pix = NULL;
+    GIcon *base_icon = NULL;
+
+    g_return_val_if_fail(width > 0 && height > 0 && scale > 0 && icon != NULL, NULL);
+
+    base_icon = xfdesktop_file_utils_get_base_icon(icon);
+    if(!base_icon)
+        return NULL;
+
+    /* images read from files can change under us, but themed icons only
+     * change with the theme */
+    if(G_IS_THEMED_ICON(base_icon)) {
+        pix = xfdesktop_file_utils_lookup_cached_icon(icon, width, height,
+                                                      scale, opacity);
+        if(pix)
+            return pix;
+
+        pix = xfdesktop_file_utils_load_themed_icon(base_icon, width, height, scale);
+        pix = xfdesktop_file_utils_finish_icon(icon, pix, MIN(width, height) * scale,
+                                               opacity);
+        xfdesktop_file_utils_cache_icon(icon, width, height, scale, opacity, pix);
+
+        return pix;
+    }
+
+    pix = xfdesktop_file_utils_load_icon_data(base_icon, width * scale,
+                                              height * scale, NULL);
+
+    return xfdesktop_file_utils_finish_icon(icon, pix, MIN(width, height) * scale,
+                                            opacity);
+}
+
+typedef struct
+{
+    GIcon *icon;
+    gint width;
+    gint height;
+    gint scale;
+    guint opacity;
+} XfdesktopIconLoadData;
+
+static void
+xfdesktop_icon_load_data_free(gpointer data)
+{
+    XfdesktopIconLoadData *load_data = data;
+
+    g_object_unref(load_data->icon);
+    g_slice_free(XfdesktopIconLoadData, load_data);
+}
+
+/* decoding is mostly CPU and disk bound, so a couple of threads keep up
+ * with the thumbnailer without starving everything else */
+#define ICON_LOAD_THREADS  2
+
+static GThreadPool *xfdesktop_icon_load_pool = NULL;
+
+static void
+xfdesktop_file_utils_load_icon_thread(gpointer data,
+                                      gpointer user_data)
+{
+    GTask *task = data;
+    XfdesktopIconLoadData *load_data = g_task_get_task_data(task);
+    GdkPixbuf *pix;
+
+    /* the icon might have gone away while this was queued */
+    if(!g_task_return_error_if_cancelled(task)) {
+        pix = xfdesktop_file_utils_load_icon_data(xfdesktop_file_utils_get_base_icon(load_data->icon),
+                                                  load_data->width * load_data->scale,
+                                                  load_data->height * load_data->scale,
+                                                  g_task_get_cancellable(task));
+
+        g_task_return_pointer(task, pix, pix ? g_object_unref : NULL);
+    }
+
+    g_object_unref(task);
+}
+
+/* Like xfdesktop_file_utils_get_icon_for_scale(), but images that have to
+ * be read and decoded (thumbnails, custom icons, remote files) are loaded
+ * by a small pool of worker threads.  Themed icons come from gtk's own cache
+ * and are loaded when the result is collected.  Loads that are cancelled
+ * before a worker gets to them are skipped. */
+void
+xfdesktop_file_utils_get_icon_async(GIcon *icon,
+                                    gint width,
+                                    gint height,
+                                    gint scale,
+                                    guint opacity,
+                                    GCancellable *cancellable,
+                                    GAsyncReadyCallback callback,
+                                    gpointer user_data)
+{
+    XfdesktopIconLoadData *load_data;
+    GIcon *base_icon;
+    GTask *task;
+
+    g_return_if_fail(width > 0 && height > 0 && scale > 0 && G_IS_ICON(icon));
+
+    load_data = g_slice_new0(XfdesktopIconLoadData);
+    load_data->icon = g_object_ref(icon);
+    load_data->width = width;
+    load_data->height = height;
+    load_data->scale = scale;
+    load_data->opacity = opacity;
+
+    task = g_task_new(NULL, cancellable, callback, user_data);
+    g_task_set_task_data(task, load_data, xfdesktop_icon_load_data_free);
+
+    base_icon = xfdesktop_file_utils_get_base_icon(icon);
+    if(base_icon && !G_IS_THEMED_ICON(base_icon)) {
+        if(G_UNLIKELY(!xfdesktop_icon_load_pool)) {
+            xfdesktop_icon_load_pool = g_thread_pool_new(xfdesktop_file_utils_load_icon_thread,
+                                                         NULL,
+                                                         ICON_LOAD_THREADS,
+                                                         FALSE,
+                                                         NULL);
+        }
+
+        /* the worker drops this reference */
+        g_thread_pool_push(xfdesktop_icon_load_pool, g_object_ref(task), NULL);
+    } else
+        g_task_return_pointer(task, NULL, NULL);
+
+    g_object_unref(task);
+}
+
+GdkPixbuf *
+xfdesktop_file_utils_get_icon_finish(GAsyncResult *result,
+                                     GError **error)
+{
+    XfdesktopIconLoadData *load_data;
+    GIcon *base_icon;
+    GdkPixbuf *pix;
+    GError *local_error = NULL;
+
+    g_return_val_if_fail(g_task_is_valid(result, NULL), NULL);
+
+    pix = g_task_propagate_pointer(G_TASK(result), &local_error);
+    if(local_error) {
+        g_propagate_error(error, local_error);
+        return NULL;
+    }
+
+    load_data = g_task_get_task_data(G_TASK(result));
+    base_icon = xfdesktop_file_utils_get_base_icon(load_data->icon);
+    if(!base_icon)
+        return NULL;
+
+    if(G_IS_THEMED_ICON(base_icon)) {
+        return xfdesktop_file_utils_get_icon_for_scale(load_data->icon,
+                                                       load_data->width,
+                                                       load_data->height,
+                                                       load_data->scale,
+                                                       load_data->opacity);
+    }
+
+    return xfdesktop_file_utils_finish_icon(load_data->icon, pix,
+                                            MIN(load_data->width, load_data->height)
+                                            * load_data->scale,
+                                            load_data->opacity);
+}
+
+/* returns a new reference to @emblem loaded at @size, or NULL */
+static GdkPixbuf *
+xfdesktop_file_utils_get_emblem_pixbuf(GIcon *emblem, gint size)
 {
+    GtkIconTheme *itheme = gtk_icon_theme_get_default();
+    GtkIconInfo *icon_info;
     GdkPixbuf *emblem_pix = NULL;
+    gchar *emblem_string, *key = NULL;
+
+    emblem_string = g_icon_to_string(emblem);
+    if(emblem_string) {
+        key = g_strdup_printf("%s@%d", emblem_string, size);
+        g_free(emblem_string);
+
+        emblem_pix = g_hash_table_lookup(xfdesktop_emblem_cache, key);
+        if(emblem_pix) {
+            g_free(key);
+            return g_object_ref(G_OBJECT(emblem_pix));
+        }
+    }
+
+    icon_info = gtk_icon_theme_lookup_by_gicon(itheme, emblem, size, ITHEME_FLAGS);
+    if(icon_info) {
+        emblem_pix = gtk_icon_info_load_icon(icon_info, NULL);
+        g_object_unref(icon_info);
+    }
+
+    if(emblem_pix
+       && (gdk_pixbuf_get_width(emblem_pix) != size
+           || gdk_pixbuf_get_height(emblem_pix) != size))
+    {
+        GdkPixbuf *tmp = gdk_pixbuf_scale_simple(emblem_pix,
+                                                 size,
+                                                 size,
+                                                 GDK_INTERP_BILINEAR);
+        g_object_unref(emblem_pix);
+        emblem_pix = tmp;
+    }
+
+    if(emblem_pix && key)
+        g_hash_table_insert(xfdesktop_emblem_cache, key, g_object_ref(G_OBJECT(emblem_pix)));
+    else
+        g_free(key);
+
+    return emblem_pix;
+}
+
+/* draws @emblems on a transparent pixbuf the size of the icon */
+static GdkPixbuf *
+xfdesktop_file_utils_render_emblem_overlay(GList *emblems,
+                                           gint pix_width,
+                                           gint pix_height)
+{
+    GdkPixbuf *overlay = NULL, *emblem_pix;
     gint max_emblems;
-    gint pix_width, pix_height;
     gint emblem_size;
     gint dest_x, dest_y, dest_width, dest_height;
     gint position;
     GList *iter;
-    GtkIconTheme *itheme = gtk_icon_theme_get_default();
-
-    g_return_if_fail(pix != NULL);
-
-    pix_width = gdk_pixbuf_get_width(pix);
-    pix_height = gdk_pixbuf_get_height(pix);
 
     emblem_size = MIN(pix_width, pix_height) / 2;
 
@@ -476,71 +869,130 @@ xfdesktop_file_utils_add_emblems(GdkPixbuf *pix, GList *emblems)
     for(iter = g_list_last(emblems), position = 0;
         iter != NULL && position < max_emblems; iter = iter->prev) {
         /* extract the icon from the emblem and load it */
-        GIcon *emblem = g_emblem_get_icon(iter->data);
-        GtkIconInfo *icon_info = gtk_icon_theme_lookup_by_gicon(itheme,
-                                                                emblem,
-                                                                emblem_size,
-                                                                ITHEME_FLAGS);
-        if(icon_info) {
-            emblem_pix = gtk_icon_info_load_icon(icon_info, NULL);
-            g_object_unref(icon_info);
+        emblem_pix = xfdesktop_file_utils_get_emblem_pixbuf(g_emblem_get_icon(iter->data),
+                                                            emblem_size);
+        if(!emblem_pix)
+            continue;
+
+        if(!overlay) {
+            overlay = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, pix_width, pix_height);
+            gdk_pixbuf_fill(overlay, 0x00000000);
         }
 
-        if(emblem_pix) {
-            if(gdk_pixbuf_get_width(emblem_pix) != emblem_size
-               || gdk_pixbuf_get_height(emblem_pix) != emblem_size)
-            {
-                GdkPixbuf *tmp = gdk_pixbuf_scale_simple(emblem_pix,
-                                                         emblem_size,
-                                                         emblem_size,
-                                                         GDK_INTERP_BILINEAR);
-                g_object_unref(emblem_pix);
-                emblem_pix = tmp;
-            }
+        dest_width = pix_width - emblem_size;
+        dest_height = pix_height - emblem_size;
 
-            dest_width = pix_width - emblem_size;
-            dest_height = pix_height - emblem_size;
-
-            switch(position) {
-                case 0: /* bottom right */
-                    dest_x = dest_width;
-                    dest_y = dest_height;
-                    break;
-                case 1: /* bottom left */
-                    dest_x = 0;
-                    dest_y = dest_height;
-                    break;
-                case 2: /* upper left */
-                    dest_x = dest_y = 0;
-                    break;
-                case 3: /* upper right */
-                    dest_x = dest_width;
-                    dest_y = 0;
-                    break;
-                default:
-                    g_warning("Invalid emblem position in xfdesktop_file_utils_add_emblems");
-            }
+        switch(position) {
+            case 0: /* bottom right */
+                dest_x = dest_width;
+                dest_y = dest_height;
+                break;
+            case 1: /* bottom left */
+                dest_x = 0;
+                dest_y = dest_height;
+                break;
+            case 2: /* upper left */
+                dest_x = dest_y = 0;
+                break;
+            case 3: /* upper right */
+                dest_x = dest_width;
+                dest_y = 0;
+                break;
+            default:
+                g_warning("Invalid emblem position in xfdesktop_file_utils_add_emblems");
+        }
+
+        DBG("calling gdk_pixbuf_composite(%p, %p, %d, %d, %d, %d, %d, %d, %.1f, %.1f, %d, %d) pixbuf w: %d h: %d",
+            emblem_pix, overlay,
+            dest_x, dest_y,
+            emblem_size, emblem_size,
+            dest_x, dest_y,
+            1.0, 1.0, GDK_INTERP_BILINEAR, 255, pix_width, pix_height);
+
+        /* Add the emblem */
+        gdk_pixbuf_composite(emblem_pix, overlay,
+                             dest_x, dest_y,
+                             emblem_size, emblem_size,
+                             dest_x, dest_y,
+                             1.0, 1.0, GDK_INTERP_BILINEAR, 255);
 
-            DBG("calling gdk_pixbuf_composite(%p, %p, %d, %d, %d, %d, %d, %d, %.1f, %.1f, %d, %d) pixbuf w: %d h: %d",
-                emblem_pix, pix,
-                dest_x, dest_y,
-                emblem_size, emblem_size,
-                dest_x, dest_y,
-                1.0, 1.0, GDK_INTERP_BILINEAR, 255, pix_width, pix_height);
+        g_object_unref(emblem_pix);
 
-            /* Add the emblem */
-            gdk_pixbuf_composite(emblem_pix, pix,
-                                 dest_x, dest_y,
-                                 emblem_size, emblem_size,
-                                 dest_x, dest_y,
-                                 1.0, 1.0, GDK_INTERP_BILINEAR, 255);
+        position++;
+    }
+
+    return overlay;
+}
+
+static void
+xfdesktop_file_utils_add_emblems(GdkPixbuf *pix, GList *emblems)
+{
+    GdkPixbuf *overlay;
+    GString *key;
+    gint pix_width, pix_height;
+    GList *iter;
+
+    g_return_if_fail(pix != NULL);
+
+    if(!emblems)
+        return;
+
+    xfdesktop_file_utils_init_icon_caches();
 
-            g_object_unref(emblem_pix);
-            emblem_pix = NULL;
+    pix_width = gdk_pixbuf_get_width(pix);
+    pix_height = gdk_pixbuf_get_height(pix);
 
-            position++;
+    /* GEmblemedIcon keeps its emblems sorted, so the same set always
+     * gives the same key */
+    key = g_string_new(NULL);
+    for(iter = emblems; iter != NULL && key; iter = iter->next) {
+        gchar *emblem_string = g_icon_to_string(g_emblem_get_icon(iter->data));
+
+        if(emblem_string) {
+            g_string_append(key, emblem_string);
+            g_string_append_c(key, '|');
+            g_free(emblem_string);
+        } else {
+            /* can't be cached */
+            g_string_free(key, TRUE);
+            key = NULL;
         }
     }
+
+    if(key) {
+        g_string_append_printf(key, "@%dx%d", pix_width, pix_height);
+
+        overlay = g_hash_table_lookup(xfdesktop_emblem_overlay_cache, key->str);
+        if(overlay) {
+            g_object_ref(G_OBJECT(overlay));
+        } else {
+            overlay = xfdesktop_file_utils_render_emblem_overlay(emblems,
+                                                                 pix_width,
+                                                                 pix_height);
+            if(overlay) {
+                if(g_hash_table_size(xfdesktop_emblem_overlay_cache) >= ICON_CACHE_MAX_ENTRIES)
+                    g_hash_table_remove_all(xfdesktop_emblem_overlay_cache);
+
+                g_hash_table_insert(xfdesktop_emblem_overlay_cache,
+                                    g_strdup(key->str),
+                                    g_object_ref(G_OBJECT(overlay)));
+            }
+        }
+
+        g_string_free(key, TRUE);
+    } else
+        overlay = xfdesktop_file_utils_render_emblem_overlay(emblems, pix_width, pix_height);
+
+    if(!overlay)
+        return;
+
+    gdk_pixbuf_composite(overlay, pix,
+                         0, 0,
+                         pix_width, pix_height,
+                         0, 0,
+                         1.0, 1.0, GDK_INTERP_NEAREST, 255);
+
+    g_object_unref(overlay);
 }
 
 void
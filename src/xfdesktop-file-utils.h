@@ -51,6 +51,21 @@ GdkPixbuf *xfdesktop_file_utils_get_icon(GIcon *icon,
                                          gint width,
                                          gint height,
                                          guint opacity);
+GdkPixbuf *xfdesktop_file_utils_get_icon_for_scale(GIcon *icon,
+                                                   gint width,
+                                                   gint height,
+                                                   gint scale,
+                                                   guint opacity);
+void xfdesktop_file_utils_get_icon_async(GIcon *icon,
+                                         gint width,
+                                         gint height,
+                                         gint scale,
+                                         guint opacity,
+                                         GCancellable *cancellable,
+                                         GAsyncReadyCallback callback,
+                                         gpointer user_data);
+GdkPixbuf *xfdesktop_file_utils_get_icon_finish(GAsyncResult *result,
+                                                GError **error);
 
 void xfdesktop_file_utils_set_window_cursor(GtkWindow *window,
                                             GdkCursorType cursor_type);
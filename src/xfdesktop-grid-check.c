@@ -0,0 +1,398 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* Checks the grid built by xfdesktop_grid_segments_new() and the dead cell
+ * mask from xfdesktop_grid_compute_dead_cells() against the way the icon
+ * view used to do it: lay out a grid over an area with the old margin and
+ * spacing arithmetic, and call a cell usable only if its rectangle is
+ * bounded by one of the monitors.  The icon view now lays out one grid per
+ * monitor, so the reference lays out one over each distinct monitor's part
+ * of the workarea, left to right, and pads the shorter ones with dead
+ * cells; with a single monitor covering the workarea that is the old
+ * whole-workarea grid.  The grid size, the dead cells and where every
+ * usable cell is drawn have to match.  Nothing in the reference is taken
+ * from the XfdesktopGridSegment the code under test computes.
+ *
+ * Random monitor layouts and cell sizes are tried; pass a seed as the
+ * first argument to repeat a failing run. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+#include <gdk/gdk.h>
+
+#include "xfdesktop-grid.h"
+
+#define N_LAYOUTS     3000
+#define MAX_MONITORS  4
+#define MIN_MARGIN    8
+
+static inline gboolean
+xfdesktop_rectangle_equal(GdkRectangle *rect1, GdkRectangle *rect2)
+{
+    return (rect1->x == rect2->x && rect1->y == rect2->y
+            && rect1->width == rect2->width && rect1->height == rect2->height);
+}
+
+static inline gboolean
+xfdesktop_rectangle_is_bounded_by(GdkRectangle *rect,
+                                  GdkRectangle *bounds)
+{
+    GdkRectangle intersection;
+
+    if(gdk_rectangle_intersect(rect, bounds, &intersection)) {
+        if(xfdesktop_rectangle_equal(rect, &intersection))
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/* a grid over one area, laid out the way xfdesktop_setup_grids() did it */
+typedef struct
+{
+    GdkRectangle area;
+    gint nrows;
+    gint ncols;
+    gint xmargin;
+    gint ymargin;
+    gint xspacing;
+    gint yspacing;
+} XfdesktopGridCheckGrid;
+
+static void
+xfdesktop_grid_check_setup_grid(XfdesktopGridCheckGrid *grid,
+                                const GdkRectangle *area,
+                                gdouble cell_size)
+{
+    gint xrest, yrest;
+
+    grid->area = *area;
+
+    grid->nrows = MAX((area->height - MIN_MARGIN * 2) / cell_size, 0);
+    grid->ncols = MAX((area->width - MIN_MARGIN * 2) / cell_size, 0);
+
+    xrest = area->width - grid->ncols * cell_size;
+    if (grid->ncols > 1) {
+        grid->xspacing = (xrest - MIN_MARGIN * 2) / (grid->ncols - 1);
+    } else {
+        /* Let's not try to divide by 0 */
+        grid->xspacing = 1;
+    }
+
+    grid->xmargin = (xrest - (grid->ncols - 1) * grid->xspacing) / 2;
+
+    yrest = area->height - grid->nrows * cell_size;
+    if (grid->nrows > 1) {
+        grid->yspacing = (yrest - MIN_MARGIN * 2) / (grid->nrows - 1);
+    } else {
+        /* Let's not try to divide by 0 */
+        grid->yspacing = 1;
+    }
+    grid->ymargin = (yrest - (grid->nrows - 1) * grid->yspacing) / 2;
+}
+
+static void
+xfdesktop_grid_check_grid_cell(const XfdesktopGridCheckGrid *grid,
+                               gdouble cell_size,
+                               gint row,
+                               gint col,
+                               GdkRectangle *cell_rect)
+{
+    cell_rect->x = grid->area.x + grid->xmargin + col * cell_size + col * grid->xspacing;
+    cell_rect->y = grid->area.y + grid->ymargin + row * cell_size + row * grid->yspacing;
+    cell_rect->width = cell_rect->height = cell_size;
+}
+
+/* the old xinerama test: a cell is usable only if some monitor holds all
+ * of it */
+static gboolean
+xfdesktop_grid_check_is_bounded(GdkRectangle *cell_rect,
+                                const GdkRectangle *monitors,
+                                gint n_monitors)
+{
+    gint i;
+
+    for(i = 0; i < n_monitors; ++i) {
+        GdkRectangle bounds = monitors[i];
+
+        if(xfdesktop_rectangle_is_bounded_by(cell_rect, &bounds))
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/* The reference grids: the distinct monitors clipped to the workarea,
+ * left to right (top to bottom for the same x), one grid each.  Returns
+ * the number of grids. */
+static gint
+xfdesktop_grid_check_reference_grids(const GdkRectangle *workarea,
+                                     const GdkRectangle *monitors,
+                                     gint n_monitors,
+                                     gdouble cell_size,
+                                     XfdesktopGridCheckGrid *grids)
+{
+    GdkRectangle areas[MAX_MONITORS], area;
+    gint i, j, n = 0;
+
+    for(i = 0; i < n_monitors; ++i) {
+        GdkRectangle monitor = monitors[i], bounds = *workarea;
+        gboolean clone = FALSE;
+
+        for(j = 0; j < i && !clone; ++j) {
+            GdkRectangle other = monitors[j];
+            clone = xfdesktop_rectangle_equal(&monitor, &other);
+        }
+
+        if(clone || !gdk_rectangle_intersect(&monitor, &bounds, &area))
+            continue;
+
+        /* insertion sort by x, then y */
+        for(j = n; j > 0
+                   && (areas[j - 1].x > area.x
+                       || (areas[j - 1].x == area.x && areas[j - 1].y > area.y));
+            --j)
+        {
+            areas[j] = areas[j - 1];
+        }
+        areas[j] = area;
+        ++n;
+    }
+
+    for(i = 0; i < n; ++i)
+        xfdesktop_grid_check_setup_grid(&grids[i], &areas[i], cell_size);
+
+    return n;
+}
+
+/* a few monitors side by side or stacked, sometimes offset against each
+ * other, sometimes cloned, with panels taken off the workarea */
+static gint
+xfdesktop_grid_check_random_layout(GRand *rand,
+                                   GdkRectangle *monitors,
+                                   GdkRectangle *workarea)
+{
+    gint n_monitors = g_rand_int_range(rand, 1, MAX_MONITORS + 1);
+    gint i, x = 0, y = 0, right = 0, bottom = 0;
+    gboolean stacked = g_rand_boolean(rand);
+
+    for(i = 0; i < n_monitors; ++i) {
+        if(i > 0 && g_rand_int_range(rand, 0, 8) == 0) {
+            /* a clone of an earlier monitor */
+            monitors[i] = monitors[g_rand_int_range(rand, 0, i)];
+            continue;
+        }
+
+        monitors[i].width = g_rand_int_range(rand, 200, 3841);
+        monitors[i].height = g_rand_int_range(rand, 200, 2161);
+
+        if(stacked) {
+            monitors[i].x = g_rand_int_range(rand, 0, 400);
+            monitors[i].y = y;
+            y += monitors[i].height;
+        } else {
+            monitors[i].x = x;
+            monitors[i].y = g_rand_int_range(rand, 0, 400);
+            x += monitors[i].width;
+        }
+
+        right = MAX(right, monitors[i].x + monitors[i].width);
+        bottom = MAX(bottom, monitors[i].y + monitors[i].height);
+    }
+
+    workarea->x = g_rand_int_range(rand, 0, 3) == 0 ? g_rand_int_range(rand, 1, 64) : 0;
+    workarea->y = g_rand_int_range(rand, 0, 3) == 0 ? g_rand_int_range(rand, 1, 64) : 0;
+    workarea->width = right - workarea->x
+                      - (g_rand_int_range(rand, 0, 3) == 0 ? g_rand_int_range(rand, 1, 64) : 0);
+    workarea->height = bottom - workarea->y
+                       - (g_rand_int_range(rand, 0, 3) == 0 ? g_rand_int_range(rand, 1, 64) : 0);
+
+    return n_monitors;
+}
+
+static void
+xfdesktop_grid_check_print_layout(gint n,
+                                  gdouble cell_size,
+                                  const GdkRectangle *workarea,
+                                  const GdkRectangle *monitors,
+                                  gint n_monitors)
+{
+    gint i;
+
+    g_printerr("  layout %d: cell size %.3f, workarea %dx%d+%d+%d\n",
+               n, cell_size,
+               workarea->width, workarea->height, workarea->x, workarea->y);
+    for(i = 0; i < n_monitors; ++i) {
+        g_printerr("  monitor %d: %dx%d+%d+%d\n", i,
+                   monitors[i].width, monitors[i].height,
+                   monitors[i].x, monitors[i].y);
+    }
+}
+
+static gboolean
+xfdesktop_grid_check_layout(GRand *rand,
+                            gint n)
+{
+    GdkRectangle monitors[MAX_MONITORS], workarea;
+    XfdesktopGridCheckGrid grids[MAX_MONITORS];
+    XfdesktopGridSegment *segments;
+    gulong *dead;
+    gdouble cell_size;
+    gint n_monitors, n_grids, n_segments, i, row, col, first_col;
+    gint nrows = 0, ncols = 0, ref_nrows = 0, ref_ncols = 0;
+    gboolean ok = TRUE;
+
+    n_monitors = xfdesktop_grid_check_random_layout(rand, monitors, &workarea);
+    cell_size = g_rand_double_range(rand, 40.0, 300.0);
+
+    n_grids = xfdesktop_grid_check_reference_grids(&workarea, monitors, n_monitors,
+                                                   cell_size, grids);
+    for(i = 0; i < n_grids; ++i) {
+        ref_nrows = MAX(ref_nrows, grids[i].nrows);
+        ref_ncols += grids[i].ncols;
+    }
+
+    segments = xfdesktop_grid_segments_new(&workarea, monitors, n_monitors,
+                                           cell_size, MIN_MARGIN, &n_segments);
+    for(i = 0; i < n_segments; ++i) {
+        nrows = MAX(nrows, segments[i].nrows);
+        ncols += segments[i].ncols;
+    }
+
+    if(nrows != ref_nrows || ncols != ref_ncols) {
+        g_printerr("grid is %dx%d but should be %dx%d\n",
+                   nrows, ncols, ref_nrows, ref_ncols);
+        xfdesktop_grid_check_print_layout(n, cell_size, &workarea,
+                                          monitors, n_monitors);
+        g_free(segments);
+        return FALSE;
+    }
+
+    dead = g_new0(gulong, MAX(GRID_N_WORDS((guint)nrows * ncols), 1));
+    xfdesktop_grid_compute_dead_cells(segments, n_segments, nrows, ncols, dead);
+
+    first_col = 0;
+    for(i = 0; i < n_grids && ok; ++i) {
+        for(col = 0; col < grids[i].ncols && ok; ++col) {
+            gint gcol = first_col + col;
+
+            for(row = 0; row < nrows && ok; ++row) {
+                GdkRectangle cell_rect;
+                gint idx = gcol * nrows + row;
+                gboolean is_dead = (dead[GRID_WORD(idx)] & GRID_BIT(idx)) != 0;
+                gboolean should_be_dead = TRUE;
+
+                if(row < grids[i].nrows) {
+                    xfdesktop_grid_check_grid_cell(&grids[i], cell_size,
+                                                   row, col, &cell_rect);
+                    should_be_dead = !xfdesktop_rectangle_is_bounded_by(&cell_rect, &workarea)
+                                     || !xfdesktop_grid_check_is_bounded(&cell_rect,
+                                                                         monitors,
+                                                                         n_monitors);
+                }
+
+                if(is_dead != should_be_dead) {
+                    g_printerr("cell %d,%d is %s but should be %s\n",
+                               row, gcol,
+                               is_dead ? "dead" : "usable",
+                               is_dead ? "usable" : "dead");
+                    ok = FALSE;
+                } else if(!is_dead) {
+                    /* where the icon view would draw it */
+                    XfdesktopGridSegment *seg = NULL;
+                    GdkRectangle drawn;
+                    gint j, seg_col;
+
+                    for(j = 0; j < n_segments; ++j) {
+                        if(gcol >= segments[j].first_col
+                           && gcol < segments[j].first_col + segments[j].ncols)
+                        {
+                            seg = &segments[j];
+                        }
+                    }
+
+                    if(!seg) {
+                        g_printerr("cell %d,%d is usable but in no segment\n",
+                                   row, gcol);
+                        ok = FALSE;
+                        break;
+                    }
+
+                    seg_col = gcol - seg->first_col;
+                    drawn.x = seg->area.x + seg->xmargin + seg_col * cell_size + seg_col * seg->xspacing;
+                    drawn.y = seg->area.y + seg->ymargin + row * cell_size + row * seg->yspacing;
+                    drawn.width = drawn.height = cell_size;
+
+                    if(!xfdesktop_rectangle_equal(&drawn, &cell_rect)) {
+                        g_printerr("cell %d,%d is at %dx%d+%d+%d but should be at %dx%d+%d+%d\n",
+                                   row, gcol,
+                                   drawn.width, drawn.height, drawn.x, drawn.y,
+                                   cell_rect.width, cell_rect.height,
+                                   cell_rect.x, cell_rect.y);
+                        ok = FALSE;
+                    }
+                }
+            }
+        }
+
+        first_col += grids[i].ncols;
+    }
+
+    if(!ok)
+        xfdesktop_grid_check_print_layout(n, cell_size, &workarea,
+                                          monitors, n_monitors);
+
+    g_free(dead);
+    g_free(segments);
+
+    return ok;
+}
+
+int
+main(int argc,
+     char **argv)
+{
+    GRand *rand;
+    guint32 seed;
+    gint i, failed = 0;
+
+    seed = argc > 1 ? (guint32)strtoul(argv[1], NULL, 10) : 20061009;
+    rand = g_rand_new_with_seed(seed);
+
+    for(i = 0; i < N_LAYOUTS; ++i) {
+        if(!xfdesktop_grid_check_layout(rand, i))
+            failed++;
+    }
+
+    g_rand_free(rand);
+
+    if(failed) {
+        g_printerr("%d of %d layouts differ (seed %u)\n", failed, N_LAYOUTS, seed);
+        return 1;
+    }
+
+    g_print("%d layouts checked (seed %u)\n", N_LAYOUTS, seed);
+
+    return 0;
+}
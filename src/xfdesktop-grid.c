@@ -0,0 +1,164 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* The geometry of the icon grid, kept free of any widget state so it can
+ * be checked on its own (see xfdesktop-grid-check.c). */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include "xfdesktop-grid.h"
+
+/* lays out the cells of a single segment inside its area */
+void
+xfdesktop_grid_layout_segment(XfdesktopGridSegment *seg,
+                              gdouble cell_size,
+                              gint min_margin)
+{
+    gint xrest, yrest;
+
+    seg->nrows = MAX((seg->area.height - min_margin * 2) / cell_size, 0);
+    seg->ncols = MAX((seg->area.width - min_margin * 2) / cell_size, 0);
+
+    xrest = seg->area.width - seg->ncols * cell_size;
+    if (seg->ncols > 1) {
+        seg->xspacing = (xrest - min_margin * 2) / (seg->ncols - 1);
+    } else {
+        /* Let's not try to divide by 0 */
+        seg->xspacing = 1;
+    }
+
+    seg->xmargin = (xrest - (seg->ncols - 1) * seg->xspacing) / 2;
+
+    yrest = seg->area.height - seg->nrows * cell_size;
+    if (seg->nrows > 1) {
+        seg->yspacing = (yrest - min_margin * 2) / (seg->nrows - 1);
+    } else {
+        /* Let's not try to divide by 0 */
+        seg->yspacing = 1;
+    }
+    seg->ymargin = (yrest - (seg->nrows - 1) * seg->yspacing) / 2;
+}
+
+static gint
+xfdesktop_grid_segment_compare(gconstpointer a,
+                               gconstpointer b,
+                               gpointer user_data)
+{
+    const XfdesktopGridSegment *seg_a = a, *seg_b = b;
+
+    if(seg_a->area.x != seg_b->area.x)
+        return seg_a->area.x < seg_b->area.x ? -1 : 1;
+
+    return seg_a->area.y < seg_b->area.y ? -1 : (seg_a->area.y > seg_b->area.y);
+}
+
+/* Splits @workarea into one grid segment per monitor, ordered left to
+ * right so that the global column numbers follow the screen.  Cloned (or
+ * overlapping) monitors share the first one's segment.  The result has
+ * room for at least one segment and is freed with g_free(). */
+XfdesktopGridSegment *
+xfdesktop_grid_segments_new(const GdkRectangle *workarea,
+                            const GdkRectangle *monitors,
+                            gint n_monitors,
+                            gdouble cell_size,
+                            gint min_margin,
+                            gint *n_segments)
+{
+    XfdesktopGridSegment *segments;
+    gint i, j, n = 0;
+    gint16 first_col = 0;
+
+    segments = g_new0(XfdesktopGridSegment, MAX(n_monitors, 1));
+
+    for(i = 0; i < n_monitors; ++i) {
+        gboolean clone = FALSE;
+
+        for(j = 0; j < i && !clone; ++j)
+            clone = gdk_rectangle_intersect(&monitors[i], &monitors[j], NULL);
+
+        if(!clone && gdk_rectangle_intersect(&monitors[i], workarea,
+                                             &segments[n].area))
+        {
+            ++n;
+        }
+    }
+
+    g_qsort_with_data(segments, n, sizeof(XfdesktopGridSegment),
+                      xfdesktop_grid_segment_compare, NULL);
+
+    for(i = 0; i < n; ++i) {
+        xfdesktop_grid_layout_segment(&segments[i], cell_size, min_margin);
+        segments[i].first_col = first_col;
+        first_col += segments[i].ncols;
+    }
+
+    *n_segments = n;
+
+    return segments;
+}
+
+/* clears the bits of the cells [start, end) */
+void
+xfdesktop_grid_clear_range(gulong *bits,
+                           gint start,
+                           gint end)
+{
+    for(; start < end && start % GRID_WORD_BITS; ++start)
+        bits[GRID_WORD(start)] &= ~GRID_BIT(start);
+
+    for(; end - start >= (gint)GRID_WORD_BITS; start += GRID_WORD_BITS)
+        bits[GRID_WORD(start)] = 0;
+
+    for(; start < end; ++start)
+        bits[GRID_WORD(start)] &= ~GRID_BIT(start);
+}
+
+/* Fills @dead, with room for @nrows * @ncols bits, with the cells of the
+ * global grid that no segment has.  Segments are usually not all the same
+ * height; the global grid is as tall as the tallest one, and the cells
+ * below the others are dead. */
+void
+xfdesktop_grid_compute_dead_cells(const XfdesktopGridSegment *segments,
+                                  gint n_segments,
+                                  gint nrows,
+                                  gint ncols,
+                                  gulong *dead)
+{
+    gint i, col;
+
+    /* everything is dead until a segment claims it */
+    memset(dead, 0xff, GRID_N_WORDS((guint)nrows * ncols) * sizeof(gulong));
+
+    for(i = 0; i < n_segments; ++i) {
+        const XfdesktopGridSegment *seg = &segments[i];
+
+        for(col = seg->first_col;
+            col < seg->first_col + seg->ncols && col < ncols;
+            ++col)
+        {
+            xfdesktop_grid_clear_range(dead, col * nrows,
+                                       col * nrows + MIN(seg->nrows, nrows));
+        }
+    }
+}
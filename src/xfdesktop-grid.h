@@ -0,0 +1,68 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __XFDESKTOP_GRID_H__
+#define __XFDESKTOP_GRID_H__
+
+#include <gdk/gdk.h>
+
+G_BEGIN_DECLS
+
+/* cell bitmaps: one bit per cell, cells numbered column by column */
+#define GRID_WORD_BITS    (sizeof(gulong) * 8)
+#define GRID_N_WORDS(n)   (((n) + GRID_WORD_BITS - 1) / GRID_WORD_BITS)
+#define GRID_BIT(idx)     (1UL << ((idx) % GRID_WORD_BITS))
+#define GRID_WORD(idx)    ((idx) / GRID_WORD_BITS)
+
+/* the part of the icon grid that lives on a single monitor */
+typedef struct
+{
+    GdkRectangle area;  /* monitor geometry clipped to the workarea */
+    gint xmargin;
+    gint ymargin;
+    gint xspacing;
+    gint yspacing;
+    gint16 nrows;
+    gint16 ncols;
+    gint16 first_col;  /* global column of the segment's first column */
+} XfdesktopGridSegment;
+
+void xfdesktop_grid_layout_segment(XfdesktopGridSegment *seg,
+                                   gdouble cell_size,
+                                   gint min_margin);
+
+XfdesktopGridSegment *xfdesktop_grid_segments_new(const GdkRectangle *workarea,
+                                                  const GdkRectangle *monitors,
+                                                  gint n_monitors,
+                                                  gdouble cell_size,
+                                                  gint min_margin,
+                                                  gint *n_segments);
+
+void xfdesktop_grid_clear_range(gulong *bits,
+                                gint start,
+                                gint end);
+
+void xfdesktop_grid_compute_dead_cells(const XfdesktopGridSegment *segments,
+                                       gint n_segments,
+                                       gint nrows,
+                                       gint ncols,
+                                       gulong *dead);
+
+G_END_DECLS
+
+#endif  /* __XFDESKTOP_GRID_H__ */
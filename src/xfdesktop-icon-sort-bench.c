@@ -0,0 +1,319 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* Times sorting a desktop's worth of icons the way "Arrange Desktop Icons"
+ * does, three ways: collating the labels on every comparison, building a
+ * collation key per label for each sort, and using the key the icon keeps
+ * (xfdesktop_icon_peek_collate_key()).  It fails if the cached keys put
+ * the icons in a different order than fresh ones, including after some
+ * of them have been renamed. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <glib-object.h>
+
+#include "xfdesktop-icon.h"
+
+#define N_ICONS    5000
+#define N_ROUNDS   10
+#define N_RENAMED  (N_ICONS / 10)
+
+
+/* fake icon */
+
+#define XFDESKTOP_TYPE_SORT_BENCH_ICON  (xfdesktop_sort_bench_icon_get_type())
+#define XFDESKTOP_SORT_BENCH_ICON(obj)  (G_TYPE_CHECK_INSTANCE_CAST((obj), XFDESKTOP_TYPE_SORT_BENCH_ICON, XfdesktopSortBenchIcon))
+
+typedef struct
+{
+    XfdesktopIcon parent;
+
+    gchar *label;
+} XfdesktopSortBenchIcon;
+
+typedef struct
+{
+    XfdesktopIconClass parent;
+} XfdesktopSortBenchIconClass;
+
+static GType xfdesktop_sort_bench_icon_get_type(void) G_GNUC_CONST;
+
+G_DEFINE_TYPE(XfdesktopSortBenchIcon, xfdesktop_sort_bench_icon, XFDESKTOP_TYPE_ICON)
+
+static void
+xfdesktop_sort_bench_icon_finalize(GObject *obj)
+{
+    g_free(XFDESKTOP_SORT_BENCH_ICON(obj)->label);
+
+    G_OBJECT_CLASS(xfdesktop_sort_bench_icon_parent_class)->finalize(obj);
+}
+
+static const gchar *
+xfdesktop_sort_bench_icon_peek_label(XfdesktopIcon *icon)
+{
+    return XFDESKTOP_SORT_BENCH_ICON(icon)->label;
+}
+
+static void
+xfdesktop_sort_bench_icon_class_init(XfdesktopSortBenchIconClass *klass)
+{
+    G_OBJECT_CLASS(klass)->finalize = xfdesktop_sort_bench_icon_finalize;
+    XFDESKTOP_ICON_CLASS(klass)->peek_label = xfdesktop_sort_bench_icon_peek_label;
+}
+
+static void
+xfdesktop_sort_bench_icon_init(XfdesktopSortBenchIcon *icon)
+{
+}
+
+/* file names like the ones found on desktops: numbered photos and
+ * documents, mixed case, accents and a few non-latin scripts */
+static gchar *
+xfdesktop_sort_bench_make_label(GRand *rand)
+{
+    static const gchar *words[] = {
+        "Document", "document", "IMG_", "Screenshot from 2016-", "Résumé",
+        "résumé", "Übersicht", "uebersicht", "notes", "Notes", "Projekt",
+        "project", "Ärger", "zebra", "Zebra", "éclair", "Eclair", "Фото",
+        "写真", "backup", "Backup", "todo", "TODO", "invoice", "Invoice",
+    };
+    static const gchar *suffixes[] = {
+        "", ".txt", ".pdf", ".jpg", ".png", ".odt", ".desktop", ".tar.gz",
+    };
+
+    return g_strdup_printf("%s%s%u%s",
+                           words[g_rand_int_range(rand, 0, G_N_ELEMENTS(words))],
+                           g_rand_boolean(rand) ? " " : "",
+                           g_rand_int_range(rand, 0, 2000),
+                           suffixes[g_rand_int_range(rand, 0, G_N_ELEMENTS(suffixes))]);
+}
+
+
+/* the arrange comparator and the two it replaced */
+
+typedef struct
+{
+    XfdesktopIcon *icon;
+    guint group;
+    const gchar *key;
+} XfdesktopSortEntry;
+
+static gint
+xfdesktop_sort_bench_compare_keys(gconstpointer a,
+                                  gconstpointer b)
+{
+    const XfdesktopSortEntry *a_entry = a, *b_entry = b;
+
+    if(a_entry->group != b_entry->group)
+        return a_entry->group < b_entry->group ? -1 : 1;
+
+    return strcmp(a_entry->key, b_entry->key);
+}
+
+static gint
+xfdesktop_sort_bench_compare_labels(gconstpointer a,
+                                    gconstpointer b)
+{
+    const XfdesktopSortEntry *a_entry = a, *b_entry = b;
+
+    if(a_entry->group != b_entry->group)
+        return a_entry->group < b_entry->group ? -1 : 1;
+
+    return g_utf8_collate(xfdesktop_icon_peek_label(a_entry->icon),
+                          xfdesktop_icon_peek_label(b_entry->icon));
+}
+
+typedef enum
+{
+    SORT_COLLATE_LABELS = 0,
+    SORT_FRESH_KEYS,
+    SORT_CACHED_KEYS,
+} XfdesktopSortMode;
+
+static const gchar *sort_mode_names[] = {
+    "g_utf8_collate() per comparison",
+    "collate key per sort",
+    "cached collate key",
+};
+
+/* sorts @icons into a new array of entries, and adds how long it took to
+ * @elapsed */
+static GArray *
+xfdesktop_sort_bench_sort(XfdesktopIcon **icons,
+                          const guint *groups,
+                          XfdesktopSortMode mode,
+                          gdouble *elapsed)
+{
+    GArray *entries;
+    GTimer *timer;
+    guint i;
+
+    timer = g_timer_new();
+
+    entries = g_array_sized_new(FALSE, FALSE, sizeof(XfdesktopSortEntry), N_ICONS);
+    for(i = 0; i < N_ICONS; ++i) {
+        XfdesktopSortEntry entry;
+
+        entry.icon = icons[i];
+        entry.group = groups[i];
+        switch(mode) {
+            case SORT_FRESH_KEYS:
+                entry.key = g_utf8_collate_key_for_filename(xfdesktop_icon_peek_label(icons[i]), -1);
+                break;
+            case SORT_CACHED_KEYS:
+                entry.key = xfdesktop_icon_peek_collate_key(icons[i]);
+                break;
+            default:
+                entry.key = NULL;
+                break;
+        }
+        g_array_append_val(entries, entry);
+    }
+
+    g_array_sort(entries, mode == SORT_COLLATE_LABELS
+                          ? xfdesktop_sort_bench_compare_labels
+                          : xfdesktop_sort_bench_compare_keys);
+
+    if(mode == SORT_FRESH_KEYS) {
+        for(i = 0; i < entries->len; ++i)
+            g_free((gchar *)g_array_index(entries, XfdesktopSortEntry, i).key);
+    }
+
+    g_timer_stop(timer);
+    *elapsed += g_timer_elapsed(timer, NULL);
+    g_timer_destroy(timer);
+
+    return entries;
+}
+
+static gboolean
+xfdesktop_sort_bench_same_order(GArray *a,
+                                GArray *b)
+{
+    guint i;
+
+    for(i = 0; i < a->len; ++i) {
+        XfdesktopSortEntry *a_entry = &g_array_index(a, XfdesktopSortEntry, i);
+        XfdesktopSortEntry *b_entry = &g_array_index(b, XfdesktopSortEntry, i);
+
+        if(a_entry->icon != b_entry->icon) {
+            g_printerr("position %u: \"%s\" where \"%s\" should be\n", i,
+                       xfdesktop_icon_peek_label(a_entry->icon),
+                       xfdesktop_icon_peek_label(b_entry->icon));
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/* sorts with @mode N_ROUNDS times and prints the best and average time */
+static void
+xfdesktop_sort_bench_time(XfdesktopIcon **icons,
+                          const guint *groups,
+                          XfdesktopSortMode mode)
+{
+    gdouble best = G_MAXDOUBLE, total = 0.0;
+    gint i;
+
+    for(i = 0; i < N_ROUNDS; ++i) {
+        gdouble elapsed = 0.0;
+
+        g_array_free(xfdesktop_sort_bench_sort(icons, groups, mode, &elapsed), TRUE);
+
+        best = MIN(best, elapsed);
+        total += elapsed;
+    }
+
+    g_print("%-34s best %8.3f ms, average %8.3f ms\n",
+            sort_mode_names[mode], best * 1000.0, total * 1000.0 / N_ROUNDS);
+}
+
+int
+main(int argc,
+     char **argv)
+{
+    XfdesktopIcon *icons[N_ICONS];
+    guint groups[N_ICONS];
+    GArray *cached, *fresh;
+    GRand *rand;
+    gdouble first = 0.0, ignored = 0.0;
+    gboolean ok;
+    gint i;
+
+    rand = g_rand_new_with_seed(20161009);
+
+    for(i = 0; i < N_ICONS; ++i) {
+        XfdesktopSortBenchIcon *icon = g_object_new(XFDESKTOP_TYPE_SORT_BENCH_ICON, NULL);
+
+        icon->label = xfdesktop_sort_bench_make_label(rand);
+        icons[i] = XFDESKTOP_ICON(icon);
+        /* mostly regular files, like on a real desktop */
+        groups[i] = g_rand_int_range(rand, 0, 10) == 0 ? g_rand_int_range(rand, 0, 3) : 3;
+    }
+
+    g_print("sorting %d icons, %d rounds each\n", N_ICONS, N_ROUNDS);
+
+    /* the cold run builds the keys the later ones reuse */
+    g_array_free(xfdesktop_sort_bench_sort(icons, groups, SORT_CACHED_KEYS, &first), TRUE);
+    g_print("%-34s          %8.3f ms\n", "cached collate key, first sort", first * 1000.0);
+
+    xfdesktop_sort_bench_time(icons, groups, SORT_COLLATE_LABELS);
+    xfdesktop_sort_bench_time(icons, groups, SORT_FRESH_KEYS);
+    xfdesktop_sort_bench_time(icons, groups, SORT_CACHED_KEYS);
+
+    cached = xfdesktop_sort_bench_sort(icons, groups, SORT_CACHED_KEYS, &ignored);
+    fresh = xfdesktop_sort_bench_sort(icons, groups, SORT_FRESH_KEYS, &ignored);
+    ok = xfdesktop_sort_bench_same_order(cached, fresh);
+    g_array_free(cached, TRUE);
+    g_array_free(fresh, TRUE);
+
+    /* renamed icons must not keep sorting under their old names */
+    if(ok) {
+        for(i = 0; i < N_RENAMED; ++i) {
+            XfdesktopSortBenchIcon *icon = XFDESKTOP_SORT_BENCH_ICON(icons[g_rand_int_range(rand, 0, N_ICONS)]);
+
+            g_free(icon->label);
+            icon->label = xfdesktop_sort_bench_make_label(rand);
+            xfdesktop_icon_label_changed(XFDESKTOP_ICON(icon));
+        }
+
+        cached = xfdesktop_sort_bench_sort(icons, groups, SORT_CACHED_KEYS, &ignored);
+        fresh = xfdesktop_sort_bench_sort(icons, groups, SORT_FRESH_KEYS, &ignored);
+        ok = xfdesktop_sort_bench_same_order(cached, fresh);
+        g_array_free(cached, TRUE);
+        g_array_free(fresh, TRUE);
+    }
+
+    for(i = 0; i < N_ICONS; ++i)
+        g_object_unref(icons[i]);
+    g_rand_free(rand);
+
+    if(!ok) {
+        g_printerr("cached collate keys sort differently from fresh ones\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,832 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* Drives an XfdesktopIconView inside a GtkOffscreenWindow through a few
+ * scripted scenarios and reports how long the resulting frames take and
+ * how much each scenario grows the heap (where mallinfo2() is there).  The
+ * view talks to a fake manager and fake icons, so nothing here touches
+ * the file system.  Without a display or a settings server it exits with
+ * 77, which "make check" counts as skipped.
+ *
+ * The grid is sized from the real screen's workarea, so to actually place
+ * 10000 icons run it on a large virtual screen, e.g.:
+ *
+ *   xvfb-run -s "-screen 0 7680x4320x24" dbus-run-session \
+ *       ./xfdesktop-icon-view-bench
+ *
+ * Icons that don't fit stay pending; the number placed is reported. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_MALLOC_H
+#include <malloc.h>
+#endif
+
+#include <gtk/gtk.h>
+
+#include <xfconf/xfconf.h>
+
+#include "xfdesktop-icon.h"
+#include "xfdesktop-icon-view.h"
+#include "xfdesktop-icon-view-manager.h"
+
+/* the icon size the view is switched to before every run, small enough for
+ * a few thousand icons to fit on a normal screen */
+#define BENCH_ICON_SIZE     32
+/* how long to wait for a step to produce a frame */
+#define FRAME_TIMEOUT       250
+/* motion events sent per hover, rubber band and drag scenario */
+#define BENCH_MOTION_STEPS  120
+
+
+/* heap use, from the allocator's own statistics; GLib and GTK allocate
+ * through it too, which is what we want to see */
+
+#if defined(HAVE_MALLOC_H) && defined(HAVE_MALLINFO2)
+
+#define BENCH_MEASURES_HEAP  TRUE
+
+static gint64
+bench_get_heap_size(void)
+{
+    struct mallinfo2 info = mallinfo2();
+
+    return (gint64)info.uordblks + (gint64)info.hblkhd;
+}
+
+#else
+
+#define BENCH_MEASURES_HEAP  FALSE
+#define bench_get_heap_size() 0
+
+#endif
+
+
+/* fake icon */
+
+#define XFDESKTOP_TYPE_BENCH_ICON  (xfdesktop_bench_icon_get_type())
+#define XFDESKTOP_BENCH_ICON(obj)  (G_TYPE_CHECK_INSTANCE_CAST((obj), XFDESKTOP_TYPE_BENCH_ICON, XfdesktopBenchIcon))
+
+typedef struct
+{
+    XfdesktopIcon parent;
+
+    gchar *label;
+    guint32 color;
+} XfdesktopBenchIcon;
+
+typedef struct
+{
+    XfdesktopIconClass parent;
+} XfdesktopBenchIconClass;
+
+static GType xfdesktop_bench_icon_get_type(void) G_GNUC_CONST;
+
+G_DEFINE_TYPE(XfdesktopBenchIcon, xfdesktop_bench_icon, XFDESKTOP_TYPE_ICON)
+
+static void
+xfdesktop_bench_icon_finalize(GObject *obj)
+{
+    g_free(XFDESKTOP_BENCH_ICON(obj)->label);
+
+    G_OBJECT_CLASS(xfdesktop_bench_icon_parent_class)->finalize(obj);
+}
+
+/* a plain square stands in for a themed icon; a new one is made for every
+ * request, the way a real icon loads its image */
+static GdkPixbuf *
+xfdesktop_bench_icon_peek_pixbuf(XfdesktopIcon *icon,
+                                 gint width,
+                                 gint height,
+                                 gint scale)
+{
+    GdkPixbuf *pix;
+
+    pix = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8,
+                         width * scale, height * scale);
+    gdk_pixbuf_fill(pix, XFDESKTOP_BENCH_ICON(icon)->color);
+
+    return pix;
+}
+
+static const gchar *
+xfdesktop_bench_icon_peek_label(XfdesktopIcon *icon)
+{
+    return XFDESKTOP_BENCH_ICON(icon)->label;
+}
+
+static const gchar *
+xfdesktop_bench_icon_peek_tooltip(XfdesktopIcon *icon)
+{
+    return XFDESKTOP_BENCH_ICON(icon)->label;
+}
+
+static gchar *
+xfdesktop_bench_icon_get_identifier(XfdesktopIcon *icon)
+{
+    return g_strdup(XFDESKTOP_BENCH_ICON(icon)->label);
+}
+
+static GdkDragAction
+xfdesktop_bench_icon_get_allowed_drag_actions(XfdesktopIcon *icon)
+{
+    return GDK_ACTION_MOVE | GDK_ACTION_COPY;
+}
+
+static GdkDragAction
+xfdesktop_bench_icon_get_allowed_drop_actions(XfdesktopIcon *icon,
+                                              GdkDragAction *suggested_action)
+{
+    if(suggested_action)
+        *suggested_action = GDK_ACTION_COPY;
+
+    return GDK_ACTION_MOVE | GDK_ACTION_COPY;
+}
+
+static void
+xfdesktop_bench_icon_class_init(XfdesktopBenchIconClass *klass)
+{
+    GObjectClass *gobject_class = (GObjectClass *)klass;
+    XfdesktopIconClass *icon_class = (XfdesktopIconClass *)klass;
+
+    gobject_class->finalize = xfdesktop_bench_icon_finalize;
+
+    icon_class->peek_pixbuf = xfdesktop_bench_icon_peek_pixbuf;
+    icon_class->peek_label = xfdesktop_bench_icon_peek_label;
+    icon_class->peek_tooltip = xfdesktop_bench_icon_peek_tooltip;
+    icon_class->get_identifier = xfdesktop_bench_icon_get_identifier;
+    icon_class->get_allowed_drag_actions = xfdesktop_bench_icon_get_allowed_drag_actions;
+    icon_class->get_allowed_drop_actions = xfdesktop_bench_icon_get_allowed_drop_actions;
+}
+
+static void
+xfdesktop_bench_icon_init(XfdesktopBenchIcon *icon)
+{
+}
+
+static XfdesktopIcon *
+xfdesktop_bench_icon_new(guint n)
+{
+    static const gchar *names[] = {
+        "Document", "Screenshot from 2019-03-14 09-26-53", "notes",
+        "Quarterly report (final) (2)", "IMG", "a",
+    };
+    XfdesktopBenchIcon *icon = g_object_new(XFDESKTOP_TYPE_BENCH_ICON, NULL);
+
+    icon->label = g_strdup_printf("%s %05u.txt",
+                                  names[n % G_N_ELEMENTS(names)], n);
+    icon->color = 0x204060ff + (n * 0x01030500);
+
+    return XFDESKTOP_ICON(icon);
+}
+
+
+/* fake manager */
+
+#define XFDESKTOP_TYPE_BENCH_MANAGER  (xfdesktop_bench_manager_get_type())
+
+typedef GObject XfdesktopBenchManager;
+typedef GObjectClass XfdesktopBenchManagerClass;
+
+static GType xfdesktop_bench_manager_get_type(void) G_GNUC_CONST;
+static void xfdesktop_bench_manager_icon_view_manager_init(XfdesktopIconViewManagerIface *iface);
+
+G_DEFINE_TYPE_EXTENDED(XfdesktopBenchManager,
+                       xfdesktop_bench_manager,
+                       G_TYPE_OBJECT, 0,
+                       G_IMPLEMENT_INTERFACE(XFDESKTOP_TYPE_ICON_VIEW_MANAGER,
+                                             xfdesktop_bench_manager_icon_view_manager_init))
+
+static void
+xfdesktop_bench_manager_class_init(XfdesktopBenchManagerClass *klass)
+{
+}
+
+static void
+xfdesktop_bench_manager_init(XfdesktopBenchManager *manager)
+{
+}
+
+static gboolean
+xfdesktop_bench_manager_real_init(XfdesktopIconViewManager *manager,
+                                  XfdesktopIconView *icon_view)
+{
+    return TRUE;
+}
+
+static void
+xfdesktop_bench_manager_fini(XfdesktopIconViewManager *manager)
+{
+}
+
+static gboolean
+xfdesktop_bench_manager_drag_drop(XfdesktopIconViewManager *manager,
+                                  XfdesktopIcon *drop_icon,
+                                  GdkDragContext *context,
+                                  gint16 row,
+                                  gint16 col,
+                                  guint time_)
+{
+    return FALSE;
+}
+
+static void
+xfdesktop_bench_manager_drag_data_received(XfdesktopIconViewManager *manager,
+                                           XfdesktopIcon *drop_icon,
+                                           GdkDragContext *context,
+                                           gint16 row,
+                                           gint16 col,
+                                           GtkSelectionData *data,
+                                           guint info,
+                                           guint time_)
+{
+}
+
+static void
+xfdesktop_bench_manager_drag_data_get(XfdesktopIconViewManager *manager,
+                                      GList *drag_icons,
+                                      GdkDragContext *context,
+                                      GtkSelectionData *data,
+                                      guint info,
+                                      guint time_)
+{
+}
+
+static GdkDragAction
+xfdesktop_bench_manager_propose_drop_action(XfdesktopIconViewManager *manager,
+                                            XfdesktopIcon *drop_icon,
+                                            GdkDragAction action,
+                                            GdkDragContext *context,
+                                            GtkSelectionData *data,
+                                            guint info)
+{
+    return action;
+}
+
+static void
+xfdesktop_bench_manager_icon_view_manager_init(XfdesktopIconViewManagerIface *iface)
+{
+    iface->manager_init = xfdesktop_bench_manager_real_init;
+    iface->manager_fini = xfdesktop_bench_manager_fini;
+    iface->drag_drop = xfdesktop_bench_manager_drag_drop;
+    iface->drag_data_received = xfdesktop_bench_manager_drag_data_received;
+    iface->drag_data_get = xfdesktop_bench_manager_drag_data_get;
+    iface->propose_drop_action = xfdesktop_bench_manager_propose_drop_action;
+}
+
+
+/* frame timing */
+
+typedef struct
+{
+    GtkWidget *window;
+    XfdesktopIconView *icon_view;
+    GtkWidget *drag_source;
+    GList *icons;
+
+    gboolean drawn;
+    gboolean timed_out;
+    gint64 draw_start;
+    gint64 draw_end;
+
+    /* totals for the scenario being run */
+    const gchar *scenario;
+    guint n_steps;
+    guint n_frames;
+    gint64 frame_total;
+    gint64 frame_max;
+    gint64 draw_total;
+    gint64 heap_start;
+    gint64 wall_start;
+} XfdesktopBench;
+
+static gboolean
+xfdesktop_bench_draw_begin(GtkWidget *widget,
+                           cairo_t *cr,
+                           gpointer user_data)
+{
+    XfdesktopBench *bench = user_data;
+
+    bench->draw_start = g_get_monotonic_time();
+
+    return FALSE;
+}
+
+static gboolean
+xfdesktop_bench_draw_end(GtkWidget *widget,
+                         cairo_t *cr,
+                         gpointer user_data)
+{
+    XfdesktopBench *bench = user_data;
+
+    bench->draw_end = g_get_monotonic_time();
+    bench->drawn = TRUE;
+
+    return FALSE;
+}
+
+static gboolean
+xfdesktop_bench_frame_timeout(gpointer user_data)
+{
+    XfdesktopBench *bench = user_data;
+
+    bench->timed_out = TRUE;
+
+    return FALSE;
+}
+
+/* runs the main loop until the view has painted or nothing has come for
+ * FRAME_TIMEOUT ms; returns whether a frame was painted */
+static gboolean
+xfdesktop_bench_wait_for_frame(XfdesktopBench *bench)
+{
+    guint timeout_id;
+
+    bench->timed_out = FALSE;
+    timeout_id = g_timeout_add(FRAME_TIMEOUT, xfdesktop_bench_frame_timeout,
+                               bench);
+
+    while(!bench->drawn && !bench->timed_out)
+        g_main_context_iteration(NULL, TRUE);
+
+    if(!bench->timed_out)
+        g_source_remove(timeout_id);
+
+    return bench->drawn;
+}
+
+static void
+xfdesktop_bench_begin_scenario(XfdesktopBench *bench,
+                               const gchar *scenario)
+{
+    /* don't let anything left over from the last scenario count here */
+    while(g_main_context_pending(NULL))
+        g_main_context_iteration(NULL, FALSE);
+
+    bench->scenario = scenario;
+    bench->n_steps = 0;
+    bench->n_frames = 0;
+    bench->frame_total = 0;
+    bench->frame_max = 0;
+    bench->draw_total = 0;
+    bench->heap_start = bench_get_heap_size();
+    bench->wall_start = g_get_monotonic_time();
+}
+
+static void
+xfdesktop_bench_end_scenario(XfdesktopBench *bench)
+{
+    gint64 wall = g_get_monotonic_time() - bench->wall_start;
+    gint64 heap = bench_get_heap_size() - bench->heap_start;
+    gchar heap_kib[32];
+
+    if(BENCH_MEASURES_HEAP)
+        g_snprintf(heap_kib, sizeof(heap_kib), "%+10.1f", heap / 1024.0);
+    else
+        g_strlcpy(heap_kib, "       n/a", sizeof(heap_kib));
+
+    g_print("  %-12s %6u %6u %9.2f %9.2f %9.2f %10.1f %s\n",
+            bench->scenario, bench->n_steps, bench->n_frames,
+            bench->n_frames ? bench->frame_total / 1000.0 / bench->n_frames : 0.0,
+            bench->frame_max / 1000.0,
+            bench->n_frames ? bench->draw_total / 1000.0 / bench->n_frames : 0.0,
+            wall / 1000.0,
+            heap_kib);
+}
+
+/* times one step: @step_start is when the step began, and the frame it
+ * caused (if any) is waited for and added to the scenario's totals */
+static void
+xfdesktop_bench_finish_step(XfdesktopBench *bench,
+                            gint64 step_start)
+{
+    gint64 frame_time;
+
+    bench->n_steps++;
+
+    if(!xfdesktop_bench_wait_for_frame(bench))
+        return;
+
+    frame_time = bench->draw_end - step_start;
+    bench->n_frames++;
+    bench->frame_total += frame_time;
+    bench->frame_max = MAX(bench->frame_max, frame_time);
+    bench->draw_total += bench->draw_end - bench->draw_start;
+}
+
+static gint64
+xfdesktop_bench_start_step(XfdesktopBench *bench)
+{
+    bench->drawn = FALSE;
+
+    return g_get_monotonic_time();
+}
+
+
+/* synthetic input */
+
+static void
+xfdesktop_bench_send_event(XfdesktopBench *bench,
+                           GdkEvent *evt)
+{
+    GdkSeat *seat = gdk_display_get_default_seat(gtk_widget_get_display(bench->window));
+
+    gdk_event_set_device(evt, gdk_seat_get_pointer(seat));
+    gtk_widget_event(bench->window, evt);
+    gdk_event_free(evt);
+}
+
+static void
+xfdesktop_bench_send_motion(XfdesktopBench *bench,
+                            gdouble x,
+                            gdouble y,
+                            GdkModifierType state)
+{
+    GdkEvent *evt = gdk_event_new(GDK_MOTION_NOTIFY);
+
+    evt->motion.window = g_object_ref(gtk_widget_get_window(bench->window));
+    evt->motion.send_event = TRUE;
+    evt->motion.time = GDK_CURRENT_TIME;
+    evt->motion.x = x;
+    evt->motion.y = y;
+    evt->motion.state = state;
+
+    xfdesktop_bench_send_event(bench, evt);
+}
+
+static void
+xfdesktop_bench_send_button(XfdesktopBench *bench,
+                            GdkEventType type,
+                            gdouble x,
+                            gdouble y)
+{
+    GdkEvent *evt = gdk_event_new(type);
+
+    evt->button.window = g_object_ref(gtk_widget_get_window(bench->window));
+    evt->button.send_event = TRUE;
+    evt->button.time = GDK_CURRENT_TIME;
+    evt->button.x = x;
+    evt->button.y = y;
+    evt->button.button = 1;
+    evt->button.state = type == GDK_BUTTON_RELEASE ? GDK_BUTTON1_MASK : 0;
+
+    xfdesktop_bench_send_event(bench, evt);
+}
+
+static void
+xfdesktop_bench_send_leave(XfdesktopBench *bench)
+{
+    GdkEvent *evt = gdk_event_new(GDK_LEAVE_NOTIFY);
+
+    evt->crossing.window = g_object_ref(gtk_widget_get_window(bench->window));
+    evt->crossing.send_event = TRUE;
+    evt->crossing.time = GDK_CURRENT_TIME;
+    evt->crossing.mode = GDK_CROSSING_NORMAL;
+    evt->crossing.detail = GDK_NOTIFY_ANCESTOR;
+
+    xfdesktop_bench_send_event(bench, evt);
+}
+
+/* collects the centres of up to @max placed icons, spread over the grid */
+static GArray *
+xfdesktop_bench_icon_centers(XfdesktopBench *bench,
+                             guint max)
+{
+    GArray *centers = g_array_new(FALSE, FALSE, sizeof(GdkPoint));
+    GList *placed = NULL, *l;
+    guint n_placed, stride, i;
+
+    for(l = bench->icons; l; l = l->next) {
+        GdkRectangle extents;
+
+        /* icons that haven't been painted have no extents yet */
+        if(xfdesktop_icon_get_extents(XFDESKTOP_ICON(l->data), NULL, NULL,
+                                      &extents)
+           && extents.width > 0)
+        {
+            placed = g_list_prepend(placed, l->data);
+        }
+    }
+    placed = g_list_reverse(placed);
+
+    n_placed = g_list_length(placed);
+    stride = MAX(1, n_placed / MAX(1, max));
+
+    for(l = placed, i = 0; l && centers->len < max; l = l->next, i++) {
+        GdkRectangle extents;
+        GdkPoint pt;
+
+        if(i % stride != 0)
+            continue;
+
+        xfdesktop_icon_get_extents(XFDESKTOP_ICON(l->data), NULL, NULL,
+                                   &extents);
+        pt.x = extents.x + extents.width / 2;
+        pt.y = extents.y + extents.height / 2;
+        g_array_append_val(centers, pt);
+    }
+
+    g_list_free(placed);
+
+    return centers;
+}
+
+static guint
+xfdesktop_bench_count_placed(XfdesktopBench *bench)
+{
+    guint n = 0;
+    GList *l;
+
+    for(l = bench->icons; l; l = l->next) {
+        gint16 row, col;
+
+        /* icons left pending never get a position */
+        if(xfdesktop_icon_get_position(XFDESKTOP_ICON(l->data), &row, &col))
+            n++;
+    }
+
+    return n;
+}
+
+
+/* scenarios */
+
+static void
+xfdesktop_bench_run_expose(XfdesktopBench *bench)
+{
+    gint i;
+
+    xfdesktop_bench_begin_scenario(bench, "expose");
+
+    for(i = 0; i < 20; i++) {
+        gint64 start = xfdesktop_bench_start_step(bench);
+
+        gtk_widget_queue_draw(bench->window);
+        xfdesktop_bench_finish_step(bench, start);
+    }
+
+    xfdesktop_bench_end_scenario(bench);
+}
+
+static void
+xfdesktop_bench_run_hover(XfdesktopBench *bench)
+{
+    GArray *centers = xfdesktop_bench_icon_centers(bench, BENCH_MOTION_STEPS);
+    guint i;
+
+    xfdesktop_bench_begin_scenario(bench, "hover");
+
+    for(i = 0; i < centers->len; i++) {
+        GdkPoint *pt = &g_array_index(centers, GdkPoint, i);
+        gint64 start = xfdesktop_bench_start_step(bench);
+
+        xfdesktop_bench_send_motion(bench, pt->x, pt->y, 0);
+        xfdesktop_bench_finish_step(bench, start);
+
+        /* move off the icon again so the next one gets picked up */
+        start = xfdesktop_bench_start_step(bench);
+        xfdesktop_bench_send_motion(bench, 1, 1, 0);
+        xfdesktop_bench_finish_step(bench, start);
+    }
+
+    xfdesktop_bench_send_leave(bench);
+    xfdesktop_bench_end_scenario(bench);
+
+    g_array_free(centers, TRUE);
+}
+
+static void
+xfdesktop_bench_run_select_all(XfdesktopBench *bench)
+{
+    gint i;
+
+    xfdesktop_bench_begin_scenario(bench, "select-all");
+
+    for(i = 0; i < 10; i++) {
+        gint64 start = xfdesktop_bench_start_step(bench);
+
+        xfdesktop_icon_view_select_all(bench->icon_view);
+        xfdesktop_bench_finish_step(bench, start);
+
+        start = xfdesktop_bench_start_step(bench);
+        xfdesktop_icon_view_unselect_all(bench->icon_view);
+        xfdesktop_bench_finish_step(bench, start);
+    }
+
+    xfdesktop_bench_end_scenario(bench);
+}
+
+static void
+xfdesktop_bench_run_rubber_band(XfdesktopBench *bench)
+{
+    gint width = gtk_widget_get_allocated_width(bench->window);
+    gint height = gtk_widget_get_allocated_height(bench->window);
+    gint i;
+
+    xfdesktop_bench_begin_scenario(bench, "rubber-band");
+
+    /* (1, 1) is inside the grid margin, so the press lands on empty space
+     * and the following motion starts a rubber band */
+    xfdesktop_bench_send_button(bench, GDK_BUTTON_PRESS, 1, 1);
+
+    /* grow the band across the whole view, then shrink it back */
+    for(i = 1; i <= BENCH_MOTION_STEPS; i++) {
+        gint step = i <= BENCH_MOTION_STEPS / 2 ? i : BENCH_MOTION_STEPS - i + 1;
+        gdouble x = 1 + (gdouble)(width - 2) * step / (BENCH_MOTION_STEPS / 2);
+        gdouble y = 1 + (gdouble)(height - 2) * step / (BENCH_MOTION_STEPS / 2);
+        gint64 start = xfdesktop_bench_start_step(bench);
+
+        xfdesktop_bench_send_motion(bench, x, y, GDK_BUTTON1_MASK);
+        xfdesktop_bench_finish_step(bench, start);
+    }
+
+    xfdesktop_bench_send_button(bench, GDK_BUTTON_RELEASE, 1, 1);
+    xfdesktop_icon_view_unselect_all(bench->icon_view);
+
+    xfdesktop_bench_end_scenario(bench);
+}
+
+static void
+xfdesktop_bench_run_arrange(XfdesktopBench *bench)
+{
+    gint i;
+
+    xfdesktop_bench_begin_scenario(bench, "arrange");
+
+    for(i = 0; i < 5; i++) {
+        gint64 start = xfdesktop_bench_start_step(bench);
+
+        xfdesktop_icon_view_sort_icons(bench->icon_view);
+        xfdesktop_bench_finish_step(bench, start);
+    }
+
+    xfdesktop_bench_end_scenario(bench);
+}
+
+/* a foreign drag (from an invisible widget on the real screen, since an
+ * offscreen window can't start one itself) hovering across the view */
+static void
+xfdesktop_bench_run_drag(XfdesktopBench *bench)
+{
+    static const GtkTargetEntry targets[] = {
+        { "text/uri-list", 0, 0 },
+    };
+    GtkTargetList *target_list;
+    GdkDragContext *context;
+    GArray *centers;
+    gboolean ret;
+    guint i;
+
+    target_list = gtk_target_list_new(targets, G_N_ELEMENTS(targets));
+    context = gtk_drag_begin_with_coordinates(bench->drag_source, target_list,
+                                              GDK_ACTION_COPY | GDK_ACTION_MOVE,
+                                              1, NULL, -1, -1);
+    gtk_target_list_unref(target_list);
+
+    if(!context) {
+        g_print("  %-12s skipped: couldn't start a drag\n", "drag");
+        return;
+    }
+
+    centers = xfdesktop_bench_icon_centers(bench, BENCH_MOTION_STEPS);
+
+    xfdesktop_bench_begin_scenario(bench, "drag");
+
+    for(i = 0; i < centers->len; i++) {
+        GdkPoint *pt = &g_array_index(centers, GdkPoint, i);
+        gint64 start = xfdesktop_bench_start_step(bench);
+
+        g_signal_emit_by_name(bench->icon_view, "drag-motion", context,
+                              pt->x, pt->y, GDK_CURRENT_TIME, &ret);
+        xfdesktop_bench_finish_step(bench, start);
+    }
+
+    g_signal_emit_by_name(bench->icon_view, "drag-leave", context,
+                          GDK_CURRENT_TIME);
+
+    xfdesktop_bench_end_scenario(bench);
+
+    gtk_drag_cancel(context);
+    g_array_free(centers, TRUE);
+}
+
+static void
+xfdesktop_bench_run(XfdesktopBench *bench,
+                    guint n_icons)
+{
+    gint64 start;
+    guint i;
+
+    for(i = 0; i < n_icons; i++)
+        bench->icons = g_list_prepend(bench->icons, xfdesktop_bench_icon_new(i));
+    bench->icons = g_list_reverse(bench->icons);
+
+    start = xfdesktop_bench_start_step(bench);
+    xfdesktop_icon_view_add_items(bench->icon_view, bench->icons);
+    xfdesktop_bench_wait_for_frame(bench);
+
+    g_print("%u icons (%u placed), first frame %.2f ms\n",
+            n_icons, xfdesktop_bench_count_placed(bench),
+            (bench->draw_end - start) / 1000.0);
+    g_print("  %-12s %6s %6s %9s %9s %9s %10s %10s\n",
+            "scenario", "steps", "frames", "avg ms", "max ms", "draw ms",
+            "total ms", "heap KiB");
+
+    xfdesktop_bench_run_expose(bench);
+    xfdesktop_bench_run_hover(bench);
+    xfdesktop_bench_run_select_all(bench);
+    xfdesktop_bench_run_rubber_band(bench);
+    xfdesktop_bench_run_arrange(bench);
+    xfdesktop_bench_run_drag(bench);
+
+    xfdesktop_icon_view_remove_all(bench->icon_view);
+    g_list_free_full(bench->icons, g_object_unref);
+    bench->icons = NULL;
+}
+
+int
+main(int argc,
+     char **argv)
+{
+    static const guint sizes[] = { 100, 1000, 10000 };
+    static const GtkTargetEntry targets[] = {
+        { "text/uri-list", 0, 0 },
+    };
+    XfdesktopBench bench = { NULL, };
+    XfdesktopIconViewManager *manager;
+    GdkScreen *gscreen;
+    GError *error = NULL;
+    guint i;
+
+    /* make GSlice allocations show up in the heap figures */
+    g_setenv("G_SLICE", "always-malloc", FALSE);
+
+    /* 77 tells "make check" the bench was skipped */
+    if(!gtk_init_check(&argc, &argv)) {
+        g_printerr("No display, skipping\n");
+        return 77;
+    }
+
+    if(!xfconf_init(&error)) {
+        g_printerr("Unable to contact settings server, skipping: %s\n", error->message);
+        g_error_free(error);
+        return 77;
+    }
+
+    gscreen = gdk_screen_get_default();
+
+    manager = g_object_new(XFDESKTOP_TYPE_BENCH_MANAGER, NULL);
+    bench.icon_view = XFDESKTOP_ICON_VIEW(xfdesktop_icon_view_new(manager));
+    xfdesktop_icon_view_set_icon_size(bench.icon_view, BENCH_ICON_SIZE);
+    xfdesktop_icon_view_set_selection_mode(bench.icon_view,
+                                           GTK_SELECTION_MULTIPLE);
+    xfdesktop_icon_view_enable_drag_dest(bench.icon_view, targets,
+                                         G_N_ELEMENTS(targets),
+                                         GDK_ACTION_COPY | GDK_ACTION_MOVE);
+
+    g_signal_connect(G_OBJECT(bench.icon_view), "draw",
+                     G_CALLBACK(xfdesktop_bench_draw_begin), &bench);
+    g_signal_connect_after(G_OBJECT(bench.icon_view), "draw",
+                           G_CALLBACK(xfdesktop_bench_draw_end), &bench);
+
+    bench.window = gtk_offscreen_window_new();
+    gtk_widget_set_size_request(bench.window,
+                                gdk_screen_get_width(gscreen),
+                                gdk_screen_get_height(gscreen));
+    gtk_container_add(GTK_CONTAINER(bench.window), GTK_WIDGET(bench.icon_view));
+    gtk_widget_show_all(bench.window);
+
+    bench.drag_source = gtk_invisible_new_for_screen(gscreen);
+    gtk_widget_show(bench.drag_source);
+
+    bench.drawn = FALSE;
+    xfdesktop_bench_wait_for_frame(&bench);
+
+    for(i = 0; i < G_N_ELEMENTS(sizes); i++)
+        xfdesktop_bench_run(&bench, sizes[i]);
+
+    gtk_widget_destroy(bench.drag_source);
+    gtk_widget_destroy(bench.window);
+    g_object_unref(manager);
+
+    xfconf_shutdown();
+
+    return 0;
+}
@@ -42,6 +42,7 @@
 #include <exo/exo.h>
 
 #include "xfdesktop-icon-view.h"
+#include "xfdesktop-grid.h"
 #include "xfdesktop-file-icon-manager.h"
 #include "xfdesktop-window-icon-manager.h"
 #include "xfdesktop-marshal.h"
@@ -56,6 +57,10 @@
 #define DEFAULT_FONT_SIZE     12
 #define DEFAULT_TOOLTIP_SIZE 128
 #define MAX_TOOLTIP_SIZE     512
+/* decoded tooltip images kept around, in bytes */
+#define TOOLTIP_CACHE_SIZE   (8 * 1024 * 1024)
+/* rendered label text kept around, in bytes */
+#define LABEL_CACHE_SIZE     (4 * 1024 * 1024)
 
 #define ICON_SIZE         (icon_view->priv->icon_size)
 #define TEXT_WIDTH        ((icon_view->priv->cell_text_width_proportion) * ICON_SIZE)
@@ -78,7 +83,7 @@
     DBG("grid layout dump:"); \
     my_maxi = icon_view->priv->nrows * icon_view->priv->ncols;\
     for(my_i = 0; my_i < my_maxi; my_i++)\
-        g_printerr("%c ", icon_view->priv->grid_layout[my_i] ? '1' : '0');\
+        g_printerr("%c ", icon_view->priv->grid_used[GRID_WORD(my_i)] & GRID_BIT(my_i) ? '1' : '0');\
     g_printerr("\n\n");\
 }
 #else
@@ -107,6 +112,31 @@ typedef struct
     guint source_id;
 } XfdesktopIdleRepaintData;
 
+typedef struct
+{
+    GdkRectangle geometry;
+    cairo_surface_t *surface;
+    cairo_region_t *dirty;
+} XfdesktopIconLayer;
+
+/* label text rendered as an alpha mask, shared by all icons showing the
+ * same text laid out the same way; it's painted in the state's color */
+typedef struct
+{
+    gchar *key;
+    cairo_surface_t *mask;
+    gsize size;
+} XfdesktopLabelMask;
+
+typedef struct
+{
+    XfdesktopIcon *icon;
+    gint width;
+    gint height;
+    GdkPixbuf *pix;
+    gsize size;
+} XfdesktopTooltipPixbuf;
+
 struct _XfdesktopIconViewPrivate
 {
     XfdesktopIconViewManager *manager;
@@ -124,19 +154,24 @@ struct _XfdesktopIconViewPrivate
     GList *icons;
     GList *selected_icons;
     
-    gint xorigin;
-    gint yorigin;
-    gint width;
-    gint height;
-
-    gint xmargin;
-    gint ymargin;
-    gint xspacing;
-    gint yspacing;
+    /* one segment per monitor; the global grid has their columns side
+     * by side and is as tall as the tallest of them */
+    XfdesktopGridSegment *segments;
+    gint n_segments;
     
     gint16 nrows;
     gint16 ncols;
     XfdesktopIcon **grid_layout;
+    /* one bit per cell, in grid_layout order: grid_used is set for cells
+     * that hold an icon or are dead, grid_dead for cells that aren't
+     * entirely on a single monitor.  there are no free cells below
+     * grid_first_free. */
+    gulong *grid_used;
+    gulong *grid_dead;
+    gint grid_first_free;
+    /* the cells holding an icon again, but in row-major order (row * ncols
+     * + col) so keyboard navigation can scan either way a word at a time */
+    gulong *grid_by_row;
     
     guint grid_resize_timeout;
     
@@ -172,6 +207,20 @@ struct _XfdesktopIconViewPrivate
     GdkDragAction proposed_drop_action;
     gint16 hover_row, hover_col;
 
+    /* what the last drag motion resolved to, so that further motion events
+     * over the same cell can answer without resolving the target again,
+     * fetching the drag data or asking the manager */
+    GdkDragContext *motion_context;
+    GdkAtom motion_target;
+    GdkDragAction motion_actions;
+    GdkDragAction motion_suggested_action;
+    GdkDragAction motion_status;
+    gboolean motion_status_valid;
+    guint motion_requests;
+
+    /* the icons being dragged from this view */
+    GHashTable *drag_icons;
+
     gint cell_padding;
     gint cell_spacing;
     gdouble label_radius;
@@ -188,6 +237,32 @@ struct _XfdesktopIconViewPrivate
     double tooltip_size_from_xfconf;
 
     gboolean single_click;
+
+    /* retained icon layer: an offscreen surface per monitor holding the
+     * rendered icons, so that exposes only need a blit */
+    gboolean retained_layer;
+    XfdesktopIconLayer *layers;
+    gint n_layers;
+
+    /* invalidations are collected here and flushed once per frame */
+    GHashTable *invalidated_icons;
+    cairo_region_t *invalidated_region;
+    guint invalidate_tick_id;
+
+    /* label masks, most recently used first */
+    GQueue label_masks;
+    GHashTable *label_mask_links;  /* key -> GList link */
+    gsize label_masks_size;
+
+    /* tooltip images, most recently used first, and the one being loaded */
+    GQueue tooltip_pixbufs;
+    GHashTable *tooltip_pixbuf_links;  /* XfdesktopIcon -> GList link */
+    GHashTable *tooltip_no_image;  /* icons whose image failed to load */
+    gsize tooltip_pixbufs_size;
+    GCancellable *tooltip_cancellable;
+    XfdesktopIcon *tooltip_loading_icon;
+    gint tooltip_loading_width;
+    gint tooltip_loading_height;
 };
 
 static void xfce_icon_view_set_property(GObject *object,
@@ -221,12 +296,21 @@ static gboolean xfdesktop_icon_view_leave_notify(GtkWidget *widget,
                                                  GdkEventCrossing *evt,
                                                  gpointer user_data);
 static void xfdesktop_icon_view_style_updated(GtkWidget *widget);
+static void xfdesktop_icon_view_scale_factor_changed(GObject *object,
+                                                     GParamSpec *pspec,
+                                                     gpointer user_data);
 static void xfdesktop_icon_view_realize(GtkWidget *widget);
 static void xfdesktop_icon_view_unrealize(GtkWidget *widget);
 static gboolean xfdesktop_icon_view_draw(GtkWidget *widget,
                                          cairo_t *cr);
 static void xfdesktop_icon_view_drag_begin(GtkWidget *widget,
                                            GdkDragContext *contest);
+static void xfdesktop_icon_view_drag_end(GtkWidget *widget,
+                                         GdkDragContext *context);
+static void xfdesktop_icon_view_reset_drag_motion(XfdesktopIconView *icon_view);
+static void xfdesktop_icon_view_drag_leave(GtkWidget *widget,
+                                           GdkDragContext *context,
+                                           guint time_);
 static gboolean xfdesktop_icon_view_drag_motion(GtkWidget *widget,
                                                 GdkDragContext *context,
                                                 gint x,
@@ -272,6 +356,9 @@ static void xfdesktop_icon_view_icon_changed(XfdesktopIcon *icon,
 
 static void xfdesktop_icon_view_invalidate_icon_pixbuf(XfdesktopIconView *icon_view,
                                                        XfdesktopIcon *icon);
+static gboolean xfdesktop_icon_view_calculate_icon_pixbuf_area(XfdesktopIconView *icon_view,
+                                                               XfdesktopIcon *icon,
+                                                               GdkRectangle *pixbuf_area);
 
 static void xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
                                            XfdesktopIcon *icon,
@@ -280,8 +367,33 @@ static void xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
 static void xfdesktop_icon_view_repaint_icons(XfdesktopIconView *icon_view,
                                               GdkRectangle *area,
                                               cairo_t *cr);
+
+static void xfdesktop_icon_view_setup_layers(XfdesktopIconView *icon_view);
+static void xfdesktop_icon_view_free_layers(XfdesktopIconView *icon_view);
+static void xfdesktop_icon_view_damage_layers(XfdesktopIconView *icon_view,
+                                              const GdkRectangle *area);
+static void xfdesktop_icon_view_draw_layers(XfdesktopIconView *icon_view,
+                                            GdkRectangle *clipbox,
+                                            cairo_t *cr);
+static void xfdesktop_icon_view_queue_draw(XfdesktopIconView *icon_view);
+static void xfdesktop_icon_view_queue_draw_region(XfdesktopIconView *icon_view,
+                                                  const cairo_region_t *region);
+static void xfdesktop_icon_view_clear_invalidations(XfdesktopIconView *icon_view);
+static void xfdesktop_icon_view_clear_label_masks(XfdesktopIconView *icon_view);
+static void xfdesktop_icon_view_drop_tooltip_pixbuf(XfdesktopIconView *icon_view,
+                                                    XfdesktopIcon *icon);
+static void xfdesktop_icon_view_clear_tooltip_pixbufs(XfdesktopIconView *icon_view);
                                   
 static void xfdesktop_setup_grids(XfdesktopIconView *icon_view);
+static void xfdesktop_grid_clear(XfdesktopIconView *icon_view);
+static void xfdesktop_grid_rebuild_used(XfdesktopIconView *icon_view);
+static gint xfdesktop_grid_bits_next(const gulong *bits,
+                                     const gulong *mask,
+                                     gint start,
+                                     gint n_bits);
+static gint xfdesktop_grid_bits_prev(const gulong *bits,
+                                     const gulong *mask,
+                                     gint start);
 static gboolean xfdesktop_grid_get_next_free_position(XfdesktopIconView *icon_view,
                                                       gint16 *row,
                                                       gint16 *col);
@@ -370,6 +482,7 @@ enum
     PROP_SINGLE_CLICK,
     PROP_SHOW_TOOLTIPS,
     PROP_TOOLTIP_SIZE,
+    PROP_RETAINED_LAYER,
 };
 
 
@@ -406,7 +519,9 @@ xfdesktop_icon_view_class_init(XfdesktopIconViewClass *klass)
     widget_class->unrealize = xfdesktop_icon_view_unrealize;
     widget_class->draw = xfdesktop_icon_view_draw;
     widget_class->drag_begin = xfdesktop_icon_view_drag_begin;
+    widget_class->drag_end = xfdesktop_icon_view_drag_end;
     widget_class->drag_motion = xfdesktop_icon_view_drag_motion;
+    widget_class->drag_leave = xfdesktop_icon_view_drag_leave;
     widget_class->drag_drop = xfdesktop_icon_view_drag_drop;
     widget_class->drag_data_get = xfdesktop_icon_view_drag_data_get;
     widget_class->drag_data_received = xfdesktop_icon_view_drag_data_received;
@@ -570,6 +685,13 @@ xfdesktop_icon_view_class_init(XfdesktopIconViewClass *klass)
                                                         -1, MAX_TOOLTIP_SIZE, -1,
                                                         XFDESKTOP_PARAM_FLAGS));
 
+    g_object_class_install_property(gobject_class, PROP_RETAINED_LAYER,
+                                    g_param_spec_boolean("retained-layer",
+                                                         "retained layer",
+                                                         "keep the rendered icons in an offscreen layer and blit it on expose",
+                                                         FALSE,
+                                                         XFDESKTOP_PARAM_FLAGS));
+
 #undef XFDESKTOP_PARAM_FLAGS
 
     /* same binding entries as GtkIconView */
@@ -659,10 +781,26 @@ xfdesktop_icon_view_init(XfdesktopIconView *icon_view)
     icon_view->priv->dest_targets = gtk_target_list_new(icon_view_targets,
                                                         icon_view_n_targets);
     gtk_drag_dest_set(GTK_WIDGET(icon_view), 0, NULL, 0, GDK_ACTION_MOVE);
+
+    icon_view->priv->invalidated_icons = g_hash_table_new(g_direct_hash,
+                                                          g_direct_equal);
+    icon_view->priv->invalidated_region = cairo_region_create();
+
+    g_queue_init(&icon_view->priv->label_masks);
+    icon_view->priv->label_mask_links = g_hash_table_new(g_str_hash,
+                                                         g_str_equal);
+
+    g_queue_init(&icon_view->priv->tooltip_pixbufs);
+    icon_view->priv->tooltip_pixbuf_links = g_hash_table_new(g_direct_hash,
+                                                             g_direct_equal);
+    icon_view->priv->tooltip_no_image = g_hash_table_new(g_direct_hash,
+                                                         g_direct_equal);
     
     g_object_set(G_OBJECT(icon_view), "has-tooltip", TRUE, NULL);
     g_signal_connect(G_OBJECT(icon_view), "query-tooltip",
                      G_CALLBACK(xfdesktop_icon_view_show_tooltip), NULL);
+    g_signal_connect(G_OBJECT(icon_view), "notify::scale-factor",
+                     G_CALLBACK(xfdesktop_icon_view_scale_factor_changed), NULL);
     
     gtk_widget_set_has_window(GTK_WIDGET(icon_view), FALSE);
     gtk_widget_set_can_focus(GTK_WIDGET(icon_view), FALSE);
@@ -689,6 +827,21 @@ xfdesktop_icon_view_finalize(GObject *obj)
     g_list_free(icon_view->priv->pending_icons);
     /* icon_view->priv->icons should be cleared in _unrealize() */
 
+    xfdesktop_icon_view_clear_invalidations(icon_view);
+    g_hash_table_destroy(icon_view->priv->invalidated_icons);
+    cairo_region_destroy(icon_view->priv->invalidated_region);
+
+    xfdesktop_icon_view_clear_label_masks(icon_view);
+    g_hash_table_destroy(icon_view->priv->label_mask_links);
+
+    if(icon_view->priv->drag_icons)
+        g_hash_table_destroy(icon_view->priv->drag_icons);
+    xfdesktop_icon_view_reset_drag_motion(icon_view);
+
+    xfdesktop_icon_view_clear_tooltip_pixbufs(icon_view);
+    g_hash_table_destroy(icon_view->priv->tooltip_pixbuf_links);
+    g_hash_table_destroy(icon_view->priv->tooltip_no_image);
+
     if (icon_view->priv->channel)
         icon_view->priv->channel = NULL;
 
@@ -716,6 +869,13 @@ xfce_icon_view_set_property(GObject *object,
             icon_view->priv->tooltip_size_from_xfconf = g_value_get_double(value);
             break;
 
+        case PROP_RETAINED_LAYER:
+            icon_view->priv->retained_layer = g_value_get_boolean(value);
+            xfdesktop_icon_view_setup_layers(icon_view);
+            if(gtk_widget_get_realized(GTK_WIDGET(icon_view)))
+                gtk_widget_queue_draw(GTK_WIDGET(icon_view));
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
             break;
@@ -743,6 +903,10 @@ xfce_icon_view_get_property(GObject *object,
             g_value_set_double(value, icon_view->priv->tooltip_size_from_xfconf);
             break;
 
+        case PROP_RETAINED_LAYER:
+            g_value_set_boolean(value, icon_view->priv->retained_layer);
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
             break;
@@ -1145,6 +1309,182 @@ xfdesktop_icon_view_maybe_begin_drag(XfdesktopIconView *icon_view,
     return TRUE;
 }
 
+static void
+xfdesktop_tooltip_pixbuf_free(XfdesktopTooltipPixbuf *tooltip_pix)
+{
+    g_object_unref(tooltip_pix->pix);
+    g_free(tooltip_pix);
+}
+
+static void
+xfdesktop_icon_view_drop_tooltip_pixbuf(XfdesktopIconView *icon_view,
+                                        XfdesktopIcon *icon)
+{
+    GList *link = g_hash_table_lookup(icon_view->priv->tooltip_pixbuf_links, icon);
+    XfdesktopTooltipPixbuf *tooltip_pix;
+
+    if(icon == icon_view->priv->tooltip_loading_icon) {
+        g_cancellable_cancel(icon_view->priv->tooltip_cancellable);
+        g_clear_object(&icon_view->priv->tooltip_cancellable);
+        icon_view->priv->tooltip_loading_icon = NULL;
+    }
+
+    if(!link)
+        return;
+
+    tooltip_pix = link->data;
+    g_hash_table_remove(icon_view->priv->tooltip_pixbuf_links, icon);
+    g_queue_delete_link(&icon_view->priv->tooltip_pixbufs, link);
+    icon_view->priv->tooltip_pixbufs_size -= tooltip_pix->size;
+    xfdesktop_tooltip_pixbuf_free(tooltip_pix);
+}
+
+static void
+xfdesktop_icon_view_clear_tooltip_pixbufs(XfdesktopIconView *icon_view)
+{
+    XfdesktopTooltipPixbuf *tooltip_pix;
+
+    if(icon_view->priv->tooltip_cancellable) {
+        g_cancellable_cancel(icon_view->priv->tooltip_cancellable);
+        g_clear_object(&icon_view->priv->tooltip_cancellable);
+    }
+    icon_view->priv->tooltip_loading_icon = NULL;
+
+    while((tooltip_pix = g_queue_pop_head(&icon_view->priv->tooltip_pixbufs)))
+        xfdesktop_tooltip_pixbuf_free(tooltip_pix);
+
+    g_hash_table_remove_all(icon_view->priv->tooltip_pixbuf_links);
+    icon_view->priv->tooltip_pixbufs_size = 0;
+
+    /* worth trying again with a new theme or size */
+    g_hash_table_remove_all(icon_view->priv->tooltip_no_image);
+}
+
+static GdkPixbuf *
+xfdesktop_icon_view_lookup_tooltip_pixbuf(XfdesktopIconView *icon_view,
+                                          XfdesktopIcon *icon,
+                                          gint width,
+                                          gint height)
+{
+    GList *link = g_hash_table_lookup(icon_view->priv->tooltip_pixbuf_links, icon);
+    XfdesktopTooltipPixbuf *tooltip_pix;
+
+    if(!link)
+        return NULL;
+
+    tooltip_pix = link->data;
+    if(tooltip_pix->width != width || tooltip_pix->height != height) {
+        xfdesktop_icon_view_drop_tooltip_pixbuf(icon_view, icon);
+        return NULL;
+    }
+
+    /* most recently used goes to the front */
+    g_queue_unlink(&icon_view->priv->tooltip_pixbufs, link);
+    g_queue_push_head_link(&icon_view->priv->tooltip_pixbufs, link);
+
+    return tooltip_pix->pix;
+}
+
+static void
+xfdesktop_icon_view_store_tooltip_pixbuf(XfdesktopIconView *icon_view,
+                                         XfdesktopIcon *icon,
+                                         gint width,
+                                         gint height,
+                                         GdkPixbuf *pix)
+{
+    XfdesktopTooltipPixbuf *tooltip_pix;
+
+    xfdesktop_icon_view_drop_tooltip_pixbuf(icon_view, icon);
+
+    tooltip_pix = g_new0(XfdesktopTooltipPixbuf, 1);
+    tooltip_pix->icon = icon;
+    tooltip_pix->width = width;
+    tooltip_pix->height = height;
+    tooltip_pix->pix = g_object_ref(pix);
+    tooltip_pix->size = (gsize)gdk_pixbuf_get_rowstride(pix) * gdk_pixbuf_get_height(pix);
+
+    g_queue_push_head(&icon_view->priv->tooltip_pixbufs, tooltip_pix);
+    g_hash_table_insert(icon_view->priv->tooltip_pixbuf_links, icon,
+                        icon_view->priv->tooltip_pixbufs.head);
+    icon_view->priv->tooltip_pixbufs_size += tooltip_pix->size;
+
+    /* evict the least recently used ones, but always keep the newest */
+    while(icon_view->priv->tooltip_pixbufs_size > TOOLTIP_CACHE_SIZE
+          && icon_view->priv->tooltip_pixbufs.length > 1)
+    {
+        tooltip_pix = g_queue_peek_tail(&icon_view->priv->tooltip_pixbufs);
+        xfdesktop_icon_view_drop_tooltip_pixbuf(icon_view, tooltip_pix->icon);
+    }
+}
+
+static void
+xfdesktop_icon_view_tooltip_pixbuf_loaded(GObject *source_object,
+                                          GAsyncResult *result,
+                                          gpointer user_data)
+{
+    XfdesktopIconView *icon_view;
+    XfdesktopIcon *icon = XFDESKTOP_ICON(source_object);
+    GdkPixbuf *pix;
+    GError *error = NULL;
+
+    pix = xfdesktop_icon_load_tooltip_pixbuf_finish(icon, result, &error);
+    if(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        /* the icon view may be gone already */
+        g_error_free(error);
+        return;
+    }
+    g_clear_error(&error);
+
+    icon_view = XFDESKTOP_ICON_VIEW(user_data);
+    icon_view->priv->tooltip_loading_icon = NULL;
+    g_clear_object(&icon_view->priv->tooltip_cancellable);
+
+    if(!pix) {
+        /* don't go to the disk again every time the tooltip is asked for */
+        g_hash_table_add(icon_view->priv->tooltip_no_image, icon);
+        return;
+    }
+
+    xfdesktop_icon_view_store_tooltip_pixbuf(icon_view, icon,
+                                             icon_view->priv->tooltip_loading_width,
+                                             icon_view->priv->tooltip_loading_height,
+                                             pix);
+    g_object_unref(pix);
+
+    if(icon == icon_view->priv->item_under_pointer)
+        gtk_widget_trigger_tooltip_query(GTK_WIDGET(icon_view));
+}
+
+static void
+xfdesktop_icon_view_load_tooltip_pixbuf(XfdesktopIconView *icon_view,
+                                        XfdesktopIcon *icon,
+                                        gint width,
+                                        gint height)
+{
+    if(icon_view->priv->tooltip_loading_icon == icon
+       && icon_view->priv->tooltip_loading_width == width
+       && icon_view->priv->tooltip_loading_height == height)
+    {
+        return;
+    }
+
+    /* only the icon under the pointer is worth loading */
+    if(icon_view->priv->tooltip_cancellable) {
+        g_cancellable_cancel(icon_view->priv->tooltip_cancellable);
+        g_object_unref(icon_view->priv->tooltip_cancellable);
+    }
+
+    icon_view->priv->tooltip_cancellable = g_cancellable_new();
+    icon_view->priv->tooltip_loading_icon = icon;
+    icon_view->priv->tooltip_loading_width = width;
+    icon_view->priv->tooltip_loading_height = height;
+
+    xfdesktop_icon_load_tooltip_pixbuf_async(icon, width, height,
+                                             icon_view->priv->tooltip_cancellable,
+                                             xfdesktop_icon_view_tooltip_pixbuf_loaded,
+                                             icon_view);
+}
+
 static gboolean
 xfdesktop_icon_view_show_tooltip(GtkWidget *widget,
                                  gint x,
@@ -1177,10 +1517,19 @@ xfdesktop_icon_view_show_tooltip(GtkWidget *widget,
     padded_tip_text = g_strdup_printf("%s\t", tip_text);
 
     if(tooltip_size > 0) {
-        gtk_tooltip_set_icon(tooltip,
-                xfdesktop_icon_peek_tooltip_pixbuf(icon_view->priv->item_under_pointer,
-                                                   tooltip_size * 1.5f,
-                                                   tooltip_size));
+        XfdesktopIcon *icon = icon_view->priv->item_under_pointer;
+        gint width = tooltip_size * 1.5f;
+        GdkPixbuf *pix;
+
+        /* the text shows up right away; if the image isn't ready yet, the
+         * tooltip gets queried again once it is */
+        pix = xfdesktop_icon_view_lookup_tooltip_pixbuf(icon_view, icon,
+                                                        width, tooltip_size);
+        if(!pix && !g_hash_table_contains(icon_view->priv->tooltip_no_image, icon))
+            xfdesktop_icon_view_load_tooltip_pixbuf(icon_view, icon,
+                                                    width, tooltip_size);
+
+        gtk_tooltip_set_icon(tooltip, pix);
     }
 
     gtk_tooltip_set_text(tooltip, padded_tip_text);
@@ -1376,17 +1725,60 @@ xfdesktop_icon_view_drag_begin(GtkWidget *widget,
     XfdesktopIconView *icon_view = XFDESKTOP_ICON_VIEW(widget);
     XfdesktopIcon *icon;
     GdkRectangle extents;
+    GList *l;
     
     icon = icon_view->priv->cursor;
     g_return_if_fail(icon);
     
     if(xfdesktop_icon_get_extents(icon, NULL, NULL, &extents)) {
-        GdkPixbuf *pix;
+        cairo_surface_t *surface;
         
-        pix = xfdesktop_icon_peek_pixbuf(icon, ICON_WIDTH, ICON_SIZE);
-        if(pix)
-            gtk_drag_set_icon_pixbuf(context, pix, 0, 0);
+        surface = xfdesktop_icon_peek_surface(icon, ICON_WIDTH, ICON_SIZE,
+                                              gtk_widget_get_scale_factor(widget),
+                                              gtk_widget_get_window(widget));
+        if(surface)
+            gtk_drag_set_icon_surface(context, surface);
+    }
+
+    /* the selection can't change during the drag, so drag motion can tell
+     * whether it's over one of the dragged icons without walking it */
+    if(icon_view->priv->drag_icons)
+        g_hash_table_destroy(icon_view->priv->drag_icons);
+    icon_view->priv->drag_icons = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for(l = icon_view->priv->selected_icons; l; l = l->next)
+        g_hash_table_add(icon_view->priv->drag_icons, l->data);
+}
+
+static void
+xfdesktop_icon_view_drag_end(GtkWidget *widget,
+                             GdkDragContext *context)
+{
+    XfdesktopIconView *icon_view = XFDESKTOP_ICON_VIEW(widget);
+
+    if(icon_view->priv->drag_icons) {
+        g_hash_table_destroy(icon_view->priv->drag_icons);
+        icon_view->priv->drag_icons = NULL;
+    }
+}
+
+static void
+xfdesktop_icon_view_reset_drag_motion(XfdesktopIconView *icon_view)
+{
+    if(icon_view->priv->motion_context) {
+        g_object_remove_weak_pointer(G_OBJECT(icon_view->priv->motion_context),
+                                     (gpointer *)&icon_view->priv->motion_context);
+        icon_view->priv->motion_context = NULL;
     }
+    icon_view->priv->motion_status_valid = FALSE;
+    icon_view->priv->motion_requests = 0;
+}
+
+static void
+xfdesktop_icon_view_drag_leave(GtkWidget *widget,
+                               GdkDragContext *context,
+                               guint time_)
+{
+    xfdesktop_icon_view_reset_drag_motion(XFDESKTOP_ICON_VIEW(widget));
 }
 
 static inline void
@@ -1396,10 +1788,31 @@ xfdesktop_xy_to_rowcol(XfdesktopIconView *icon_view,
                        gint16 *row,
                        gint16 *col)
 {
+    gint i;
+
     g_return_if_fail(row && col);
-    
-    *row = (y - icon_view->priv->yorigin - icon_view->priv->ymargin) / (CELL_SIZE + icon_view->priv->yspacing);
-    *col = (x - icon_view->priv->xorigin - icon_view->priv->xmargin) / (CELL_SIZE + icon_view->priv->xspacing);
+
+    for(i = 0; i < icon_view->priv->n_segments; ++i) {
+        XfdesktopGridSegment *seg = &icon_view->priv->segments[i];
+        gint16 seg_col;
+
+        if(!xfdesktop_rectangle_contains_point(&seg->area, x, y))
+            continue;
+
+        *row = (y - seg->area.y - seg->ymargin) / (CELL_SIZE + seg->yspacing);
+        seg_col = (x - seg->area.x - seg->xmargin) / (CELL_SIZE + seg->xspacing);
+
+        /* don't spill over into the neighbouring segment */
+        if(seg_col >= seg->ncols)
+            break;
+
+        *col = seg->first_col + seg_col;
+        return;
+    }
+
+    /* not over any cell; callers treat this as out of range */
+    *row = icon_view->priv->nrows;
+    *col = icon_view->priv->ncols;
 }
 
 static gboolean
@@ -1416,19 +1829,47 @@ xfdesktop_icon_view_drag_motion(GtkWidget *widget,
     GdkDragAction our_action = 0;
     gboolean is_local_drag;
     
-    target = gtk_drag_dest_find_target(widget, context, 
-                                       icon_view->priv->native_targets);
-    if(target == GDK_NONE) {
-        target = gtk_drag_dest_find_target(widget, context,
-                                           icon_view->priv->dest_targets);
-        if(target == GDK_NONE)
-            return FALSE;
-    }
+    /* the targets don't change during a drag */
+    if(context != icon_view->priv->motion_context) {
+        xfdesktop_icon_view_reset_drag_motion(icon_view);
+
+        target = gtk_drag_dest_find_target(widget, context, 
+                                           icon_view->priv->native_targets);
+        if(target == GDK_NONE) {
+            target = gtk_drag_dest_find_target(widget, context,
+                                               icon_view->priv->dest_targets);
+        }
+
+        /* weak, so that a later drag's context allocated at the same
+         * address isn't mistaken for this one */
+        icon_view->priv->motion_context = context;
+        g_object_add_weak_pointer(G_OBJECT(context),
+                                  (gpointer *)&icon_view->priv->motion_context);
+        icon_view->priv->motion_target = target;
+    } else
+        target = icon_view->priv->motion_target;
+
+    if(target == GDK_NONE)
+        return FALSE;
     
     /* can we drop here? */
     xfdesktop_xy_to_rowcol(icon_view, x, y, &hover_row, &hover_col);
     if(hover_row >= icon_view->priv->nrows || hover_col >= icon_view->priv->ncols)
         return FALSE;
+
+    /* still over the same cell with the same actions on offer: the answer
+     * hasn't changed */
+    if(icon_view->priv->motion_status_valid
+       && hover_row == icon_view->priv->hover_row
+       && hover_col == icon_view->priv->hover_col
+       && gdk_drag_context_get_actions(context) == icon_view->priv->motion_actions
+       && gdk_drag_context_get_suggested_action(context) == icon_view->priv->motion_suggested_action)
+    {
+        gdk_drag_status(context, icon_view->priv->motion_status, time_);
+        return TRUE;
+    }
+    icon_view->priv->motion_status_valid = FALSE;
+
     icon_on_dest = xfdesktop_icon_view_icon_in_cell(icon_view, hover_row,
                                                     hover_col);
     if(icon_on_dest) {
@@ -1456,18 +1897,14 @@ xfdesktop_icon_view_drag_motion(GtkWidget *widget,
         GdkDragAction allowed_actions = gdk_drag_context_get_actions(context);
 
         if(is_local_drag) {  /* #2 */
-            GList *l;
-            gint16 sel_row, sel_col;
             gboolean action_ask = FALSE;
             
             /* check to make sure we aren't just hovering over ourself */
-            for(l = icon_view->priv->selected_icons; l; l = l->next) {
-                XfdesktopIcon *sel_icon = l->data;
-                if(xfdesktop_icon_get_position(sel_icon, &sel_row, &sel_col)
-                   && sel_row == hover_row && sel_col == hover_col)
-                {
-                    return FALSE;
-                }
+            if(icon_view->priv->drag_icons
+               ? g_hash_table_contains(icon_view->priv->drag_icons, icon_on_dest)
+               : xfdesktop_icon_view_is_icon_selected(icon_view, icon_on_dest))
+            {
+                return FALSE;
             }
             
             if(allowed_actions & GDK_ACTION_ASK)
@@ -1513,6 +1950,9 @@ xfdesktop_icon_view_drag_motion(GtkWidget *widget,
     icon_view->priv->hover_col = hover_col;
     icon_view->priv->proposed_drop_action = our_action;
     icon_view->priv->dropped = FALSE;
+    icon_view->priv->motion_actions = gdk_drag_context_get_actions(context);
+    icon_view->priv->motion_suggested_action = gdk_drag_context_get_suggested_action(context);
+    icon_view->priv->motion_requests++;
     g_object_set_data(G_OBJECT(context), "--xfdesktop-icon-view-drop-icon",
                       icon_on_dest);
     gtk_drag_get_data(widget, context, target, time_);
@@ -1545,6 +1985,7 @@ xfdesktop_icon_view_drag_drop(GtkWidget *widget,
     icon_view->priv->maybe_begin_drag = FALSE;
     icon_view->priv->definitely_dragging = FALSE;
     icon_view->priv->dropped = TRUE;
+    xfdesktop_icon_view_reset_drag_motion(icon_view);
     
     target = gtk_drag_dest_find_target(widget, context, 
                                        icon_view->priv->native_targets);
@@ -1732,58 +2173,59 @@ xfdesktop_icon_view_drag_data_received(GtkWidget *widget,
         }
 
         gdk_drag_status(context, action, time_);
+
+        /* remember the answer once the last request for this cell is in */
+        if(context == icon_view->priv->motion_context
+           && icon_view->priv->motion_requests > 0
+           && --icon_view->priv->motion_requests == 0)
+        {
+            icon_view->priv->motion_status = action;
+            icon_view->priv->motion_status_valid = TRUE;
+        }
     }
 }
 
 #ifdef ENABLE_FILE_ICONS
-static gint
-xfdesktop_icon_view_compare_icons(gconstpointer *a,
-                                  gconstpointer *b)
+typedef struct
 {
-    XfdesktopIcon *a_icon, *b_icon;
-    const gchar *a_str, *b_str;
-
-    a_icon = XFDESKTOP_ICON(a);
-    b_icon = XFDESKTOP_ICON(b);
+    XfdesktopIcon *icon;
+    guint group;
+    const gchar *key;
+} XfdesktopSortEntry;
 
-    a_str = xfdesktop_icon_peek_label(a_icon);
-    b_str = xfdesktop_icon_peek_label(b_icon);
+static gint
+xfdesktop_icon_view_compare_sort_entries(gconstpointer a,
+                                         gconstpointer b)
+{
+    const XfdesktopSortEntry *a_entry = a, *b_entry = b;
 
-    if(a_str == NULL)
-        a_str = "";
-    if(b_str == NULL)
-        b_str = "";
+    if(a_entry->group != b_entry->group)
+        return a_entry->group < b_entry->group ? -1 : 1;
 
-    return g_utf8_collate(a_str, b_str);
+    return strcmp(a_entry->key, b_entry->key);
 }
-#endif /* ENABLE_FILE_ICONS */
 
-#ifdef ENABLE_FILE_ICONS
-static void
-xfdesktop_icon_view_append_icons(XfdesktopIconView *icon_view,
-                                 GList *icon_list,
-                                 gint16 *row,
-                                 gint16 *col)
+/* special icons first, then volumes, folders and everything else. The
+ * file type comes from the info the icon already holds, querying it here
+ * would block on slow or remote desktop folders */
+static guint
+xfdesktop_icon_view_sort_group(XfdesktopIcon *icon)
 {
-    GList *l = NULL;
-    for(l = icon_list; l != NULL; l = g_list_next(l)) {
+    GFileInfo *info;
 
-        /* Find the next available spot for an icon */
-        do {
-            if(*row + 1 >= icon_view->priv->nrows) {
-                ++*col;
-                *row = 0;
-            } else {
-                ++*row;
-            }
-        } while(!xfdesktop_grid_is_free_position(icon_view, *row, *col));
+    if(XFDESKTOP_IS_SPECIAL_FILE_ICON(icon))
+        return 0;
 
-        /* set new position */
-        xfdesktop_icon_set_position(l->data, *row, *col);
-        xfdesktop_grid_unset_position_free(icon_view, l->data);
+    if(XFDESKTOP_IS_VOLUME_ICON(icon))
+        return 1;
 
-        xfdesktop_icon_view_invalidate_icon(icon_view, l->data, TRUE);
+    if(XFDESKTOP_IS_FILE_ICON(icon)) {
+        info = xfdesktop_file_icon_peek_file_info(XFDESKTOP_FILE_ICON(icon));
+        if(info && g_file_info_get_file_type(info) == G_FILE_TYPE_DIRECTORY)
+            return 2;
     }
+
+    return 3;
 }
 #endif /* ENABLE_FILE_ICONS */
 
@@ -1792,12 +2234,14 @@ xfdesktop_icon_view_sort_icons(XfdesktopIconView *icon_view)
 {
 #ifdef ENABLE_FILE_ICONS
     GList *l = NULL;
+    GArray *entries;
     guint i;
-    GList *icons[4] = { NULL, NULL, NULL, NULL };
-    gint16 row = -1; /* start at -1 because we'll increment it */
-    gint16 col = 0;
+
+    entries = g_array_sized_new(FALSE, FALSE, sizeof(XfdesktopSortEntry),
+                                g_list_length(icon_view->priv->icons));
 
     for(l = icon_view->priv->icons; l; l = l->next) {
+        XfdesktopSortEntry entry;
         gint16 old_row, old_col;
 
         /* clear out old position */
@@ -1806,32 +2250,41 @@ xfdesktop_icon_view_sort_icons(XfdesktopIconView *icon_view)
         if(xfdesktop_icon_get_position(l->data, &old_row, &old_col))
             xfdesktop_grid_set_position_free(icon_view, old_row, old_col);
 
-        /* Choose the correct list index */
-        if(XFDESKTOP_IS_SPECIAL_FILE_ICON(l->data)) {
-            i = 0;
-        } else if(XFDESKTOP_IS_VOLUME_ICON(l->data)) {
-            i = 1;
-        } else if(XFDESKTOP_IS_FILE_ICON(l->data) &&
-                  g_file_query_file_type(xfdesktop_file_icon_peek_file(l->data),
-                                         G_FILE_QUERY_INFO_NONE,
-                                         NULL) == G_FILE_TYPE_DIRECTORY)
-        {
-            i = 2;
-        } else {
-            i = 3;
+        entry.icon = l->data;
+        entry.group = xfdesktop_icon_view_sort_group(l->data);
+        entry.key = xfdesktop_icon_peek_collate_key(l->data);
+        g_array_append_val(entries, entry);
+    }
+
+    g_array_sort(entries, xfdesktop_icon_view_compare_sort_entries);
+
+    /* The grid is empty now, so the free cells come out in the order the
+     * icons go in: special, volumes, folders, then regular */
+    for(i = 0; i < entries->len; ++i) {
+        XfdesktopSortEntry *entry = &g_array_index(entries, XfdesktopSortEntry, i);
+        gint16 row, col;
+
+        if(!xfdesktop_grid_get_next_free_position(icon_view, &row, &col)) {
+            /* can't happen unless the grid shrank under us; let the
+             * pending list deal with it like after a resize */
+            g_signal_handlers_disconnect_by_func(G_OBJECT(entry->icon),
+                                                 G_CALLBACK(xfdesktop_icon_view_icon_changed),
+                                                 icon_view);
+            g_hash_table_remove(icon_view->priv->invalidated_icons, entry->icon);
+            icon_view->priv->icons = g_list_remove(icon_view->priv->icons, entry->icon);
+            icon_view->priv->pending_icons = g_list_prepend(icon_view->priv->pending_icons,
+                                                            entry->icon);
+            continue;
         }
 
-        /* Add the icon to the correct list */
-        icons[i] = g_list_prepend(icons[i], l->data);
-    }
+        /* set new position */
+        xfdesktop_icon_set_position(entry->icon, row, col);
+        xfdesktop_grid_unset_position_free(icon_view, entry->icon);
 
-    /* Append the icons: special, folder, then regular */
-    for(i = 0; i < sizeof(icons) / sizeof(icons[0]); ++i) {
-        l = g_list_sort(icons[i],
-                        (GCompareFunc)xfdesktop_icon_view_compare_icons);
-        xfdesktop_icon_view_append_icons(icon_view, l, &row, &col);
-        g_list_free(l);
+        xfdesktop_icon_view_invalidate_icon(icon_view, entry->icon, TRUE);
     }
+
+    g_array_free(entries, TRUE);
 #endif
 }
 
@@ -1839,9 +2292,31 @@ static void
 xfdesktop_icon_view_icon_theme_changed(GtkIconTheme *icon_theme,
                                        gpointer user_data)
 {
-    gtk_widget_queue_draw(GTK_WIDGET(user_data));
+    xfdesktop_icon_view_clear_tooltip_pixbufs(XFDESKTOP_ICON_VIEW(user_data));
+    xfdesktop_icon_view_queue_draw(XFDESKTOP_ICON_VIEW(user_data));
 }    
 
+/* everything that was rendered in device pixels has to be redone */
+static void
+xfdesktop_icon_view_scale_factor_changed(GObject *object,
+                                         GParamSpec *pspec,
+                                         gpointer user_data)
+{
+    XfdesktopIconView *icon_view = XFDESKTOP_ICON_VIEW(object);
+
+    XF_DEBUG("scale factor is now %d",
+             gtk_widget_get_scale_factor(GTK_WIDGET(icon_view)));
+
+    /* icon images reload themselves when they're asked for at a new
+     * scale, but the other caches don't know about it */
+    xfdesktop_icon_view_clear_label_masks(icon_view);
+    xfdesktop_icon_view_clear_tooltip_pixbufs(icon_view);
+    xfdesktop_icon_view_setup_layers(icon_view);
+
+    if(gtk_widget_get_realized(GTK_WIDGET(icon_view)))
+        xfdesktop_icon_view_queue_draw(icon_view);
+}
+
 static void
 xfdesktop_icon_view_style_updated(GtkWidget *widget)
 {
@@ -1865,6 +2340,9 @@ xfdesktop_icon_view_style_updated(GtkWidget *widget)
     XF_DEBUG("tooltip size is %d", icon_view->priv->tooltip_size_from_style);
     XF_DEBUG("label radius is %f", icon_view->priv->label_radius);
 
+    /* label colors, backgrounds and sizes may all have changed */
+    xfdesktop_icon_view_clear_label_masks(icon_view);
+    xfdesktop_icon_view_damage_layers(icon_view, NULL);
 
     GTK_WIDGET_CLASS(xfdesktop_icon_view_parent_class)->style_updated(widget);
 }
@@ -1995,6 +2473,9 @@ xfdesktop_icon_view_unrealize(GtkWidget *widget)
                                          G_CALLBACK(xfdesktop_screen_size_changed_cb),
                                          icon_view);
     
+    xfdesktop_icon_view_clear_invalidations(icon_view);
+    xfdesktop_icon_view_clear_label_masks(icon_view);
+
     /* FIXME: really clear these? */
     g_list_free(icon_view->priv->selected_icons);
     icon_view->priv->selected_icons = NULL;
@@ -2003,6 +2484,17 @@ xfdesktop_icon_view_unrealize(GtkWidget *widget)
 
     g_free(icon_view->priv->grid_layout);
     icon_view->priv->grid_layout = NULL;
+    g_free(icon_view->priv->grid_used);
+    icon_view->priv->grid_used = NULL;
+    g_free(icon_view->priv->grid_dead);
+    icon_view->priv->grid_dead = NULL;
+    g_free(icon_view->priv->grid_by_row);
+    icon_view->priv->grid_by_row = NULL;
+    g_free(icon_view->priv->segments);
+    icon_view->priv->segments = NULL;
+    icon_view->priv->n_segments = 0;
+
+    xfdesktop_icon_view_free_layers(icon_view);
     
     g_object_unref(G_OBJECT(icon_view->priv->playout));
     icon_view->priv->playout = NULL;
@@ -2033,7 +2525,10 @@ xfdesktop_icon_view_draw(GtkWidget *widget,
 
     gdk_cairo_get_clip_rectangle(cr, &clipbox);
 
-    xfdesktop_icon_view_repaint_icons(icon_view, &clipbox, cr);
+    if(icon_view->priv->layers)
+        xfdesktop_icon_view_draw_layers(icon_view, &clipbox, cr);
+    else
+        xfdesktop_icon_view_repaint_icons(icon_view, &clipbox, cr);
 
     if(icon_view->priv->definitely_rubber_banding) {
         GdkRectangle intersect;
@@ -2177,59 +2672,59 @@ xfdesktop_icon_view_select_between(XfdesktopIconView *icon_view,
     }
 }
 
+/* the first and last icons are in row-major order */
 static XfdesktopIcon *
 xfdesktop_icon_view_find_first_icon(XfdesktopIconView *icon_view)
 {
-    gint i, j;
-    XfdesktopIcon *icon = NULL;
+    gint idx;
 
-    if(!icon_view->priv->icons)
+    if(!icon_view->priv->icons || !icon_view->priv->grid_layout)
         return NULL;
 
-    for(i = 0; i < icon_view->priv->nrows && !icon; ++i) {
-        for(j = 0; j < icon_view->priv->ncols; ++j) {
-            icon = xfdesktop_icon_view_icon_in_cell(icon_view, i, j);
-            if(icon)
-                break;
-        }
-    }
+    idx = xfdesktop_grid_bits_next(icon_view->priv->grid_by_row, NULL, 0,
+                                   icon_view->priv->nrows * icon_view->priv->ncols);
+    if(idx < 0)
+        return NULL;
 
-    return icon;
+    return xfdesktop_icon_view_icon_in_cell(icon_view,
+                                            idx / icon_view->priv->ncols,
+                                            idx % icon_view->priv->ncols);
 }
 
 static XfdesktopIcon *
 xfdesktop_icon_view_find_last_icon(XfdesktopIconView *icon_view)
 {
-    XfdesktopIcon *icon = NULL;
-    gint i, j;
+    gint idx;
 
-    if(!icon_view->priv->icons)
+    if(!icon_view->priv->icons || !icon_view->priv->grid_layout)
         return NULL;
 
-    for(i = icon_view->priv->nrows - 1; i >= 0 && !icon; --i) {
-        for(j = icon_view->priv->ncols - 1; j >= 0; --j) {
-            icon = xfdesktop_icon_view_icon_in_cell(icon_view, i, j);
-            if(icon)
-                break;
-        }
-    }
+    idx = xfdesktop_grid_bits_prev(icon_view->priv->grid_by_row, NULL,
+                                   icon_view->priv->nrows * icon_view->priv->ncols - 1);
+    if(idx < 0)
+        return NULL;
 
-    return icon;
+    return xfdesktop_icon_view_icon_in_cell(icon_view,
+                                            idx / icon_view->priv->ncols,
+                                            idx % icon_view->priv->ncols);
 }
 
+/* moves the cursor over the next |count| icons, walking the grid row by
+ * row for left/right and column by column (grid_layout order) for up/down */
 static void
-xfdesktop_icon_view_move_cursor_left_right(XfdesktopIconView *icon_view,
-                                           gint count,
-                                           GdkModifierType modmask)
+xfdesktop_icon_view_move_cursor_linear(XfdesktopIconView *icon_view,
+                                       gboolean by_row,
+                                       gint count,
+                                       GdkModifierType modmask)
 {
     gint16 row, col;
-    gint i, j;
+    gint idx, n_cells;
     guint left = (count < 0 ? -count : count);
-    gint step = (count < 0 ? -1 : 1);
+    const gulong *bits, *mask;
     XfdesktopIcon *icon = NULL;
 
     if(!icon_view->priv->cursor) {
-        /* choose first or last item depending on left or right */
+        /* choose first or last item depending on the direction */
         if(count < 0)
             icon = xfdesktop_icon_view_find_last_icon(icon_view);
         else
@@ -2248,22 +2743,39 @@ xfdesktop_icon_view_move_cursor_left_right(XfdesktopIconView *icon_view,
         if(!(modmask & (GDK_SHIFT_MASK|GDK_CONTROL_MASK)))
             xfdesktop_icon_view_unselect_all(icon_view);
 
-        for(i = row;
-            (count < 0 ? i >= 0 : i < icon_view->priv->nrows) && left > 0;
-            i += step)
-        {
-            for(j = (i == row ? col + step : (count < 0) ? icon_view->priv->ncols - 1 : 0);
-                (count < 0 ? j >= 0 : j < icon_view->priv->ncols) && left > 0;
-                j += step)
-            {
-                icon = xfdesktop_icon_view_icon_in_cell(icon_view, i, j);
-                if(icon) {
-                    icon_view->priv->cursor = icon;
-                    if((modmask & (GDK_SHIFT_MASK|GDK_CONTROL_MASK)) || left == 1)
-                        xfdesktop_icon_view_select_item(icon_view, icon);
-                    left--;
-                }
-            }
+        n_cells = icon_view->priv->nrows * icon_view->priv->ncols;
+
+        if(by_row) {
+            bits = icon_view->priv->grid_by_row;
+            mask = NULL;
+            idx = row * icon_view->priv->ncols + col;
+        } else {
+            /* the used cells that aren't dead are the ones with icons */
+            bits = icon_view->priv->grid_used;
+            mask = icon_view->priv->grid_dead;
+            idx = col * icon_view->priv->nrows + row;
+        }
+
+        while(left > 0 && icon_view->priv->grid_layout) {
+            if(count < 0)
+                idx = xfdesktop_grid_bits_prev(bits, mask, idx - 1);
+            else
+                idx = xfdesktop_grid_bits_next(bits, mask, idx + 1, n_cells);
+
+            if(idx < 0)
+                break;
+
+            if(by_row) {
+                icon = xfdesktop_icon_view_icon_in_cell(icon_view,
+                                                        idx / icon_view->priv->ncols,
+                                                        idx % icon_view->priv->ncols);
+            } else
+                icon = xfdesktop_icon_view_icon_in_cell_raw(icon_view, idx);
+
+            icon_view->priv->cursor = icon;
+            if((modmask & (GDK_SHIFT_MASK|GDK_CONTROL_MASK)) || left == 1)
+                xfdesktop_icon_view_select_item(icon_view, icon);
+            left--;
         }
 
         if(!icon_view->priv->selected_icons) {
@@ -2280,68 +2792,21 @@ xfdesktop_icon_view_move_cursor_left_right(XfdesktopIconView *icon_view,
     }
 }
 
+static void
+xfdesktop_icon_view_move_cursor_left_right(XfdesktopIconView *icon_view,
+                                           gint count,
+                                           GdkModifierType modmask)
+{
+    xfdesktop_icon_view_move_cursor_linear(icon_view, TRUE, count, modmask);
+}
+
 static void
 xfdesktop_icon_view_move_cursor_up_down(XfdesktopIconView *icon_view,
                                         gint count,
                                         GdkModifierType modmask)
 {
-    gint16 row, col;
-    gint i, j;
-    guint left = (count < 0 ? -count : count);
-    gint step = (count < 0 ? -1 : 1);
-    XfdesktopIcon *icon = NULL;
-
-    if(!icon_view->priv->cursor) {
-        /* choose first or last item depending on up or down */
-        if(count < 0)
-            icon = xfdesktop_icon_view_find_last_icon(icon_view);
-        else
-            icon = xfdesktop_icon_view_find_first_icon(icon_view);
-
-        if(icon) {
-            if(!(modmask & GDK_CONTROL_MASK))
-                xfdesktop_icon_view_unselect_all(icon_view);
-            icon_view->priv->cursor = icon;
-            xfdesktop_icon_view_select_item(icon_view, icon);
-        }
-    } else {
-        if(!xfdesktop_icon_get_position(icon_view->priv->cursor, &row, &col))
-            return;
-
-        if(!(modmask & (GDK_SHIFT_MASK|GDK_CONTROL_MASK)))
-            xfdesktop_icon_view_unselect_all(icon_view);
-
-        for(j = col;
-            (count < 0 ? j >= 0 : j < icon_view->priv->ncols) && left > 0;
-            j += step)
-        {
-        for(i = (j == col ? row + step : (count < 0) ? icon_view->priv->nrows - 1 : 0);
-            (count < 0 ? i >= 0 : i < icon_view->priv->nrows) && left > 0;
-            i += step)
-        {
-                icon = xfdesktop_icon_view_icon_in_cell(icon_view, i, j);
-                if(icon) {
-                    icon_view->priv->cursor = icon;
-                    if((modmask & (GDK_SHIFT_MASK|GDK_CONTROL_MASK)) || left == 1)
-                        xfdesktop_icon_view_select_item(icon_view, icon);
-                    left--;
-                }
-            }
-        }
-
-        if(!icon_view->priv->selected_icons) {
-            if(count < 0)
-                icon = xfdesktop_icon_view_find_first_icon(icon_view);
-            else
-                icon = xfdesktop_icon_view_find_last_icon(icon_view);
-            
-            if(icon) {
-                xfdesktop_icon_view_select_item(icon_view, icon);
-                icon_view->priv->cursor = icon;
-            }
-        }
-    }
-}
+    xfdesktop_icon_view_move_cursor_linear(icon_view, FALSE, count, modmask);
+}
 
 static void
 xfdesktop_icon_view_move_cursor_begin_end(XfdesktopIconView *icon_view,
@@ -2465,166 +2930,342 @@ xfdesktop_icon_view_repaint_icons(XfdesktopIconView *icon_view,
     }
 }
 
-static inline gboolean
-xfdesktop_rectangle_equal(GdkRectangle *rect1, GdkRectangle *rect2)
+static void
+xfdesktop_icon_view_free_layers(XfdesktopIconView *icon_view)
 {
-    return (rect1->x == rect2->x && rect1->y == rect2->y
-            && rect1->width == rect2->width && rect1->height == rect2->height);
+    gint i;
+
+    for(i = 0; i < icon_view->priv->n_layers; ++i) {
+        if(icon_view->priv->layers[i].surface)
+            cairo_surface_destroy(icon_view->priv->layers[i].surface);
+        cairo_region_destroy(icon_view->priv->layers[i].dirty);
+    }
+
+    g_free(icon_view->priv->layers);
+    icon_view->priv->layers = NULL;
+    icon_view->priv->n_layers = 0;
 }
 
-static inline gboolean
-xfdesktop_rectangle_is_bounded_by(GdkRectangle *rect,
-                                  GdkRectangle *bounds)
+static void
+xfdesktop_icon_view_setup_layers(XfdesktopIconView *icon_view)
+{
+    GdkScreen *gscreen;
+    gint i;
+
+    xfdesktop_icon_view_free_layers(icon_view);
+
+    if(!icon_view->priv->retained_layer
+       || !gtk_widget_get_realized(GTK_WIDGET(icon_view)))
+    {
+        return;
+    }
+
+    gscreen = gtk_widget_get_screen(GTK_WIDGET(icon_view));
+    icon_view->priv->n_layers = gdk_screen_get_n_monitors(gscreen);
+    icon_view->priv->layers = g_new0(XfdesktopIconLayer, icon_view->priv->n_layers);
+
+    for(i = 0; i < icon_view->priv->n_layers; ++i) {
+        XfdesktopIconLayer *layer = &icon_view->priv->layers[i];
+
+        gdk_screen_get_monitor_geometry(gscreen, i, &layer->geometry);
+
+        /* the surface itself is created on the first expose, so until
+         * then all of it is dirty */
+        layer->dirty = cairo_region_create_rectangle(&layer->geometry);
+    }
+
+    XF_DEBUG("set up %d retained icon layers", icon_view->priv->n_layers);
+}
+
+/* marks @area (or everything, if @area is NULL) as needing to be
+ * re-rendered into the retained layers on the next expose */
+static void
+xfdesktop_icon_view_damage_layers(XfdesktopIconView *icon_view,
+                                  const GdkRectangle *area)
 {
     GdkRectangle intersection;
-    
-    if(gdk_rectangle_intersect(rect, bounds, &intersection)) {
-        if(xfdesktop_rectangle_equal(rect, &intersection))
-            return TRUE;
+    gint i;
+
+    for(i = 0; i < icon_view->priv->n_layers; ++i) {
+        XfdesktopIconLayer *layer = &icon_view->priv->layers[i];
+
+        if(!area)
+            cairo_region_union_rectangle(layer->dirty, &layer->geometry);
+        else if(gdk_rectangle_intersect(area, &layer->geometry, &intersection))
+            cairo_region_union_rectangle(layer->dirty, &intersection);
     }
-    
-    return FALSE;
 }
 
-/* FIXME: add a cache for this so we don't have to compute this EVERY time */
 static void
-xfdesktop_icon_view_setup_grids_xinerama(XfdesktopIconView *icon_view)
+xfdesktop_icon_view_queue_draw(XfdesktopIconView *icon_view)
+{
+    xfdesktop_icon_view_damage_layers(icon_view, NULL);
+    gtk_widget_queue_draw(GTK_WIDGET(icon_view));
+}
+
+static void
+xfdesktop_icon_view_queue_draw_region(XfdesktopIconView *icon_view,
+                                      const cairo_region_t *region)
+{
+    GdkRectangle rect;
+    gint i, n_rects;
+
+    n_rects = cairo_region_num_rectangles(region);
+    for(i = 0; i < n_rects; ++i) {
+        cairo_region_get_rectangle(region, i, &rect);
+        xfdesktop_icon_view_damage_layers(icon_view, &rect);
+    }
+
+    gtk_widget_queue_draw_region(GTK_WIDGET(icon_view), region);
+}
+
+static void
+xfdesktop_icon_view_draw_layers(XfdesktopIconView *icon_view,
+                                GdkRectangle *clipbox,
+                                cairo_t *cr)
+{
+    GdkWindow *window = gtk_widget_get_window(GTK_WIDGET(icon_view));
+    cairo_region_t *covered;
+    gint i;
+
+    covered = cairo_region_create();
+
+    for(i = 0; i < icon_view->priv->n_layers; ++i) {
+        XfdesktopIconLayer *layer = &icon_view->priv->layers[i];
+        cairo_region_t *visible, *damaged;
+        GdkRectangle area;
+
+        if(!gdk_rectangle_intersect(clipbox, &layer->geometry, &area))
+            continue;
+
+        /* overlapping (e.g. cloned) monitors must only be blitted once,
+         * or the translucent parts of the icons would get darker */
+        visible = cairo_region_create_rectangle(&area);
+        cairo_region_subtract(visible, covered);
+        cairo_region_union_rectangle(covered, &area);
+        if(cairo_region_is_empty(visible)) {
+            cairo_region_destroy(visible);
+            continue;
+        }
+
+        if(!layer->surface) {
+            layer->surface = gdk_window_create_similar_surface(window,
+                                                               CAIRO_CONTENT_COLOR_ALPHA,
+                                                               layer->geometry.width,
+                                                               layer->geometry.height);
+        }
+
+        /* only the damaged part of what we're about to show needs to be
+         * rendered again, the rest of the layer is still valid */
+        damaged = cairo_region_copy(layer->dirty);
+        cairo_region_intersect(damaged, visible);
+        if(!cairo_region_is_empty(damaged)) {
+            cairo_t *layer_cr = cairo_create(layer->surface);
+            GdkRectangle extents;
+
+            cairo_translate(layer_cr, -layer->geometry.x, -layer->geometry.y);
+            gdk_cairo_region(layer_cr, damaged);
+            cairo_clip(layer_cr);
+
+            cairo_set_operator(layer_cr, CAIRO_OPERATOR_CLEAR);
+            cairo_paint(layer_cr);
+            cairo_set_operator(layer_cr, CAIRO_OPERATOR_OVER);
+
+            cairo_region_get_extents(damaged, &extents);
+            xfdesktop_icon_view_repaint_icons(icon_view, &extents, layer_cr);
+
+            cairo_destroy(layer_cr);
+            cairo_region_subtract(layer->dirty, damaged);
+        }
+        cairo_region_destroy(damaged);
+
+        cairo_save(cr);
+        gdk_cairo_region(cr, visible);
+        cairo_clip(cr);
+        cairo_set_source_surface(cr, layer->surface,
+                                 layer->geometry.x, layer->geometry.y);
+        cairo_paint(cr);
+        cairo_restore(cr);
+
+        cairo_region_destroy(visible);
+    }
+
+    cairo_region_destroy(covered);
+}
+
+static inline gboolean
+xfdesktop_grid_segment_equal(const XfdesktopGridSegment *a,
+                             const XfdesktopGridSegment *b)
+{
+    return a->area.x == b->area.x && a->area.y == b->area.y
+           && a->area.width == b->area.width && a->area.height == b->area.height
+           && a->nrows == b->nrows && a->ncols == b->ncols
+           && a->xmargin == b->xmargin && a->ymargin == b->ymargin
+           && a->xspacing == b->xspacing && a->yspacing == b->yspacing;
+}
+
+/* Splits the workarea into one grid segment per monitor, ordered left to
+ * right so that the global column numbers follow the screen. */
+static XfdesktopGridSegment *
+xfdesktop_grid_compute_segments(XfdesktopIconView *icon_view,
+                                gint *n_segments)
 {
 #if 0 /* GTK_CHECK_VERSION (3, 22, 0) */
     GdkDisplay *display;
-#else
-    GdkScreen *gscreen;
 #endif
-    GdkRectangle *monitor_geoms, cell_rect;
-    gint nmonitors, i, row, col;
-    
-    DBG("entering");
+    GdkScreen *gscreen;
+    GdkRectangle workarea, *monitor_geoms;
+    XfdesktopGridSegment *segments;
+    gint nmonitors, i;
+
+    gscreen = gtk_widget_get_screen(GTK_WIDGET(icon_view));
+
+    if(!xfdesktop_get_workarea_single(icon_view, 0,
+                                      &workarea.x, &workarea.y,
+                                      &workarea.width, &workarea.height))
+    {
+        workarea.x = workarea.y = 0;
+        workarea.width = gdk_screen_get_width(gscreen);
+        workarea.height = gdk_screen_get_height(gscreen);
+    }
 
 #if 0 /* GTK_CHECK_VERSION (3, 22, 0) */
     display = gtk_widget_get_display(GTK_WIDGET(icon_view));
     nmonitors = gdk_display_get_n_monitors(display);
 #else
-    gscreen = gtk_widget_get_screen(GTK_WIDGET(icon_view));
     nmonitors = gdk_screen_get_n_monitors(gscreen);
 #endif
-    if(nmonitors == 1)  /* optimisation */
-        return;
-    
+
     monitor_geoms = g_new0(GdkRectangle, nmonitors);
 
-#if 0 /* GTK_CHECK_VERSION (3, 22, 0) */
     for(i = 0; i < nmonitors; ++i) {
+#if 0 /* GTK_CHECK_VERSION (3, 22, 0) */
         gdk_monitor_get_geometry(gdk_display_get_monitor(display, i), &monitor_geoms[i]);
-    }
 #else
-    for(i = 0; i < nmonitors; ++i) {
         gdk_screen_get_monitor_geometry(gscreen, i, &monitor_geoms[i]);
-    }
 #endif
+    }
 
-    /* cubic time; w00t! */
-    cell_rect.width = cell_rect.height = CELL_SIZE;
-    for(row = 0; row < icon_view->priv->nrows; ++row) {
-        for(col = 0; col < icon_view->priv->ncols; ++col) {
-            gboolean bounded = FALSE;
+    segments = xfdesktop_grid_segments_new(&workarea, monitor_geoms, nmonitors,
+                                           CELL_SIZE, MIN_MARGIN, n_segments);
 
-            cell_rect.x = icon_view->priv->xorigin + icon_view->priv->xmargin + col * CELL_SIZE + col * icon_view->priv->xspacing;
-            cell_rect.y = icon_view->priv->yorigin + icon_view->priv->ymargin + row * CELL_SIZE + row * icon_view->priv->yspacing;
+    g_free(monitor_geoms);
 
-            for(i = 0; i < nmonitors; ++i) {
-                if(xfdesktop_rectangle_is_bounded_by(&cell_rect,
-                                                     &monitor_geoms[i]))
-                {
-                    bounded = TRUE;
-                    break;
-                }
-            }
-            
-            if(!bounded) {
-                xfdesktop_grid_unset_position_free_raw(icon_view, row, col,
-                                                       (gpointer)0xdeadbeef);
-            }
-        }
+    for(i = 0; i < *n_segments; ++i) {
+        XF_DEBUG("segment %d: %dx%d+%d+%d, %dx%d cells starting at column %d",
+                 i, segments[i].area.width, segments[i].area.height,
+                 segments[i].area.x, segments[i].area.y,
+                 segments[i].nrows, segments[i].ncols, segments[i].first_col);
     }
-    
-    g_free(monitor_geoms);
-    
-    DBG("exiting");
+
+    return segments;
+}
+
+static inline XfdesktopGridSegment *
+xfdesktop_grid_segment_for_col(XfdesktopIconView *icon_view,
+                               gint16 col)
+{
+    gint i;
+
+    for(i = icon_view->priv->n_segments - 1; i >= 0; --i) {
+        if(col >= icon_view->priv->segments[i].first_col)
+            return col < icon_view->priv->segments[i].first_col + icon_view->priv->segments[i].ncols
+                   ? &icon_view->priv->segments[i] : NULL;
+    }
+
+    return NULL;
 }
-    
 
 static void
-xfdesktop_setup_grids(XfdesktopIconView *icon_view)
+xfdesktop_grid_setup_dead_cells(XfdesktopIconView *icon_view)
+{
+    DBG("entering");
+
+    if(icon_view->priv->grid_dead == NULL)
+        return;
+
+    xfdesktop_grid_compute_dead_cells(icon_view->priv->segments,
+                                      icon_view->priv->n_segments,
+                                      icon_view->priv->nrows,
+                                      icon_view->priv->ncols,
+                                      icon_view->priv->grid_dead);
+}
+
+/* takes ownership of @segments */
+static void
+xfdesktop_setup_grids_with_segments(XfdesktopIconView *icon_view,
+                                    XfdesktopGridSegment *segments,
+                                    gint n_segments)
 {
-    gint xorigin = 0, yorigin = 0, xrest = 0, yrest = 0, width = 0, height = 0;
     gsize old_size, new_size;
+    gint i;
     
     old_size = (guint)icon_view->priv->nrows * icon_view->priv->ncols
                * sizeof(XfdesktopIcon *);
-    
-    if(!xfdesktop_get_workarea_single(icon_view, 0,
-                                      &xorigin, &yorigin,
-                                      &width, &height))
-    {
-        GdkScreen *gscreen = gtk_widget_get_screen(GTK_WIDGET(icon_view));
-        width = gdk_screen_get_width(gscreen);
-        height = gdk_screen_get_height(gscreen);
-        xorigin = yorigin = 0;
-    }
-    
-    icon_view->priv->xorigin = xorigin;
-    icon_view->priv->yorigin = yorigin;
-    icon_view->priv->width = width;
-    icon_view->priv->height = height;
-
-    icon_view->priv->nrows = MAX((height - MIN_MARGIN * 2) / CELL_SIZE, 0);
-    icon_view->priv->ncols = MAX((width - MIN_MARGIN * 2) / CELL_SIZE, 0);
 
-    xrest = icon_view->priv->width - icon_view->priv->ncols * CELL_SIZE;
-    if (icon_view->priv->ncols > 1) {
-        icon_view->priv->xspacing = (xrest - MIN_MARGIN * 2) / (icon_view->priv->ncols - 1);
-    } else {
-        /* Let's not try to divide by 0 */
-        icon_view->priv->xspacing = 1;
-    }
+    g_free(icon_view->priv->segments);
+    icon_view->priv->segments = segments;
+    icon_view->priv->n_segments = n_segments;
 
-    icon_view->priv->xmargin = (xrest - (icon_view->priv->ncols - 1) * icon_view->priv->xspacing) / 2;
+    /* the monitor layout may have changed too */
+    xfdesktop_icon_view_setup_layers(icon_view);
 
-    yrest = icon_view->priv->height - icon_view->priv->nrows * CELL_SIZE;
-    if (icon_view->priv->nrows > 1) {
-        icon_view->priv->yspacing = (yrest - MIN_MARGIN * 2) / (icon_view->priv->nrows - 1);
-    } else {
-        /* Let's not try to divide by 0 */
-        icon_view->priv->yspacing = 1;
+    icon_view->priv->nrows = 0;
+    icon_view->priv->ncols = 0;
+    for(i = 0; i < icon_view->priv->n_segments; ++i) {
+        icon_view->priv->nrows = MAX(icon_view->priv->nrows,
+                                     icon_view->priv->segments[i].nrows);
+        icon_view->priv->ncols += icon_view->priv->segments[i].ncols;
     }
-    icon_view->priv->ymargin = (yrest - (icon_view->priv->nrows - 1) * icon_view->priv->yspacing) / 2;
 
     new_size = (guint)icon_view->priv->nrows * icon_view->priv->ncols
                * sizeof(XfdesktopIcon *);
 
     if(old_size == new_size && icon_view->priv->grid_layout != NULL) {
-        DBG("old_size == new_size exiting");
-        return;
+        DBG("old_size == new_size, keeping grid_layout");
+    } else {
+        gsize n_words = GRID_N_WORDS(new_size / sizeof(XfdesktopIcon *));
+
+        XF_DEBUG("CELL_SIZE=%0.3f, TEXT_WIDTH=%0.3f, ICON_SIZE=%u", CELL_SIZE, TEXT_WIDTH, ICON_SIZE);
+        XF_DEBUG("grid size is %dx%d", icon_view->priv->nrows, icon_view->priv->ncols);
+
+        if(icon_view->priv->grid_layout) {
+            icon_view->priv->grid_layout = g_realloc(icon_view->priv->grid_layout,
+                                                     new_size);
+
+            if(new_size > old_size) {
+                memset(((guint8 *)icon_view->priv->grid_layout) + old_size, 0,
+                       new_size - old_size);
+            }
+        } else
+            icon_view->priv->grid_layout = g_malloc0(new_size);
+
+        g_free(icon_view->priv->grid_used);
+        g_free(icon_view->priv->grid_dead);
+        g_free(icon_view->priv->grid_by_row);
+        icon_view->priv->grid_used = g_new0(gulong, n_words);
+        icon_view->priv->grid_dead = g_new0(gulong, n_words);
+        icon_view->priv->grid_by_row = g_new0(gulong, n_words);
+
+        XF_DEBUG("created grid_layout with %lu positions", (gulong)(new_size/sizeof(gpointer)));
     }
 
-    XF_DEBUG("CELL_SIZE=%0.3f, TEXT_WIDTH=%0.3f, ICON_SIZE=%u", CELL_SIZE, TEXT_WIDTH, ICON_SIZE);
-    XF_DEBUG("grid size is %dx%d", icon_view->priv->nrows, icon_view->priv->ncols);
+    /* the segments can change without the grid size changing, so the
+     * dead cells always have to be worked out again */
+    xfdesktop_grid_setup_dead_cells(icon_view);
+    xfdesktop_grid_rebuild_used(icon_view);
 
-    if(icon_view->priv->grid_layout) {
-        icon_view->priv->grid_layout = g_realloc(icon_view->priv->grid_layout,
-                                                 new_size);
-        
-        if(new_size > old_size) {
-            memset(((guint8 *)icon_view->priv->grid_layout) + old_size, 0,
-                   new_size - old_size);
-        }
-    } else
-        icon_view->priv->grid_layout = g_malloc0(new_size);
-    
-    XF_DEBUG("created grid_layout with %lu positions", (gulong)(new_size/sizeof(gpointer)));
     DUMP_GRID_LAYOUT(icon_view);
-    
-    xfdesktop_icon_view_setup_grids_xinerama(icon_view);
+}
+
+static void
+xfdesktop_setup_grids(XfdesktopIconView *icon_view)
+{
+    XfdesktopGridSegment *segments;
+    gint n_segments;
+
+    segments = xfdesktop_grid_compute_segments(icon_view, &n_segments);
+    xfdesktop_setup_grids_with_segments(icon_view, segments, n_segments);
 }
 
 static GdkFilterReturn
@@ -2649,76 +3290,130 @@ xfdesktop_rootwin_watch_workarea(GdkXEvent *gxevent,
     return GDK_FILTER_CONTINUE;
 }
 
+/* runs from the frame clock's update phase, so whatever gets queued here
+ * is painted in the same frame */
+static gboolean
+xfdesktop_icon_view_flush_invalidations(GtkWidget *widget,
+                                        GdkFrameClock *frame_clock,
+                                        gpointer user_data)
+{
+    XfdesktopIconView *icon_view = XFDESKTOP_ICON_VIEW(widget);
+    GHashTableIter iter;
+    gpointer key;
+
+    icon_view->priv->invalidate_tick_id = 0;
+
+    g_hash_table_iter_init(&iter, icon_view->priv->invalidated_icons);
+    while(g_hash_table_iter_next(&iter, &key, NULL)) {
+        XfdesktopIcon *icon = XFDESKTOP_ICON(key);
+        GdkRectangle pixbuf_extents, text_extents, box_extents, total_extents;
+
+        if(!xfdesktop_icon_view_update_icon_extents(icon_view, icon,
+                                                    &pixbuf_extents,
+                                                    &text_extents,
+                                                    &box_extents,
+                                                    &total_extents))
+        {
+            g_warning("Trying to invalidate icon, but can't recalculate extents");
+        } else {
+            cairo_region_union_rectangle(icon_view->priv->invalidated_region,
+                                         &total_extents);
+        }
+    }
+    g_hash_table_remove_all(icon_view->priv->invalidated_icons);
+
+    if(!cairo_region_is_empty(icon_view->priv->invalidated_region)) {
+        xfdesktop_icon_view_queue_draw_region(icon_view,
+                                              icon_view->priv->invalidated_region);
+        cairo_region_destroy(icon_view->priv->invalidated_region);
+        icon_view->priv->invalidated_region = cairo_region_create();
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+xfdesktop_icon_view_schedule_invalidations(XfdesktopIconView *icon_view)
+{
+    if(icon_view->priv->invalidate_tick_id == 0) {
+        icon_view->priv->invalidate_tick_id = gtk_widget_add_tick_callback(GTK_WIDGET(icon_view),
+                                                                           xfdesktop_icon_view_flush_invalidations,
+                                                                           NULL, NULL);
+    }
+}
+
+static void
+xfdesktop_icon_view_clear_invalidations(XfdesktopIconView *icon_view)
+{
+    if(icon_view->priv->invalidate_tick_id != 0) {
+        gtk_widget_remove_tick_callback(GTK_WIDGET(icon_view),
+                                        icon_view->priv->invalidate_tick_id);
+        icon_view->priv->invalidate_tick_id = 0;
+    }
+
+    g_hash_table_remove_all(icon_view->priv->invalidated_icons);
+    cairo_region_destroy(icon_view->priv->invalidated_region);
+    icon_view->priv->invalidated_region = cairo_region_create();
+}
+
 static void
 xfdesktop_icon_view_invalidate_icon(XfdesktopIconView *icon_view,
                                     XfdesktopIcon *icon,
                                     gboolean recalc_extents)
 {
-    GdkRectangle extents, box_extents;
-    gboolean invalidated_something = FALSE;
+    GdkRectangle extents;
+    gboolean have_extents;
     
     g_return_if_fail(icon);
     
     /*DBG("entering (recalc=%s)", recalc_extents?"true":"false");*/
 
-    /* we always have to invalidate the old extents */
-    if(xfdesktop_icon_get_extents(icon, NULL, NULL, &extents)) {
-        if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
-            gtk_widget_queue_draw_area(GTK_WIDGET(icon_view), extents.x,
-                                       extents.y, extents.width,
-                                       extents.height);
-        }
-        invalidated_something = TRUE;
-    } else
-        recalc_extents = TRUE;
-    
-    if(recalc_extents) {
-        GdkRectangle pixbuf_extents, text_extents, total_extents;
+    have_extents = xfdesktop_icon_get_extents(icon, NULL, NULL, &extents);
 
-        if(!xfdesktop_icon_view_update_icon_extents(icon_view, icon,
+    if(!gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
+        /* nothing to draw, but keep the extents current */
+        if(recalc_extents || !have_extents) {
+            GdkRectangle pixbuf_extents, text_extents, box_extents, total_extents;
+
+            xfdesktop_icon_view_update_icon_extents(icon_view, icon,
                                                     &pixbuf_extents,
                                                     &text_extents,
                                                     &box_extents,
-                                                    &total_extents))
-        {
-            g_warning("Trying to invalidate icon, but can't recalculate extents");
-        } else if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
-            gtk_widget_queue_draw_area(GTK_WIDGET(icon_view),
-                                       total_extents.x, total_extents.y,
-                                       total_extents.width, total_extents.height);
-            invalidated_something = TRUE;
+                                                    &total_extents);
         }
+        return;
     }
 
-    if(!invalidated_something) {
-        DBG("Icon '%s' doesn't have extents: need to call paint some other way",
-            xfdesktop_icon_peek_label(icon));
-    }
+    /* we always have to invalidate the old extents; the new ones are
+     * calculated only once per frame, no matter how many times the icon
+     * gets invalidated before that */
+    if(have_extents)
+        cairo_region_union_rectangle(icon_view->priv->invalidated_region, &extents);
+
+    if(recalc_extents || !have_extents)
+        g_hash_table_add(icon_view->priv->invalidated_icons, icon);
+
+    xfdesktop_icon_view_schedule_invalidations(icon_view);
 }
 
 static void
 xfdesktop_icon_view_invalidate_icon_pixbuf(XfdesktopIconView *icon_view,
                                            XfdesktopIcon *icon)
 {
-    GdkPixbuf *pix;
-    
-    pix = xfdesktop_icon_peek_pixbuf(icon, ICON_WIDTH, ICON_SIZE);
-    if(pix) {
-        GdkRectangle rect = { 0, };
-        
-        rect.width = gdk_pixbuf_get_width(pix);
-        rect.height = gdk_pixbuf_get_height(pix);
+    GdkRectangle rect = { 0, };
 
-        if(!xfdesktop_icon_view_shift_area_to_cell(icon_view, icon, &rect))
-            return;
-        
-        rect.x += CELL_PADDING + ((CELL_SIZE - 2 * CELL_PADDING) - rect.width) / 2;
-        rect.y += CELL_PADDING + (ICON_SIZE - rect.height) / 2;;
-    
-        if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
-            gtk_widget_queue_draw_area(GTK_WIDGET(icon_view), rect.x, rect.y,
-                                       rect.width, rect.height);
-        }
+    xfdesktop_icon_view_calculate_icon_pixbuf_area(icon_view, icon, &rect);
+
+    if(!xfdesktop_icon_view_shift_area_to_cell(icon_view, icon, &rect))
+        return;
+
+    rect.x += CELL_PADDING + ((CELL_SIZE - 2 * CELL_PADDING) - rect.width) / 2;
+    rect.y += CELL_PADDING + (ICON_SIZE - rect.height) / 2;
+
+    if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
+        cairo_region_union_rectangle(icon_view->priv->invalidated_region,
+                                     &rect);
+        xfdesktop_icon_view_schedule_invalidations(icon_view);
     }
 }
 
@@ -2727,8 +3422,6 @@ xfdesktop_icon_view_calculate_icon_pixbuf_area(XfdesktopIconView *icon_view,
                                                XfdesktopIcon *icon,
                                                GdkRectangle *pixbuf_area)
 {
-    GdkPixbuf *pix;
-
     g_return_val_if_fail(XFDESKTOP_IS_ICON_VIEW(icon_view)
                          && XFDESKTOP_IS_ICON(icon)
                          && pixbuf_area, FALSE);
@@ -2736,13 +3429,15 @@ xfdesktop_icon_view_calculate_icon_pixbuf_area(XfdesktopIconView *icon_view,
     pixbuf_area->x = 0;
     pixbuf_area->y = 0;
 
-    pix = xfdesktop_icon_peek_pixbuf(icon, ICON_WIDTH, ICON_SIZE);
-    if(G_LIKELY(pix)) {
-        pixbuf_area->width = gdk_pixbuf_get_width(pix);
-        pixbuf_area->height = gdk_pixbuf_get_height(pix);
-    } else {
-        /* presumably this should never happen, but... */
-        pixbuf_area->width = ICON_SIZE;
+    /* Don't load the image just to measure it.  Until it gets painted the
+     * icon takes up the most room any image for it could, so whatever
+     * gets invalidated with these extents covers the real image too. */
+    if(!xfdesktop_icon_get_pixbuf_size(icon, ICON_WIDTH, ICON_SIZE,
+                                       gtk_widget_get_scale_factor(GTK_WIDGET(icon_view)),
+                                       &pixbuf_area->width,
+                                       &pixbuf_area->height))
+    {
+        pixbuf_area->width = ICON_WIDTH;
         pixbuf_area->height = ICON_SIZE;
     }
 
@@ -2805,6 +3500,7 @@ xfdesktop_icon_view_shift_area_to_cell(XfdesktopIconView *icon_view,
                                        XfdesktopIcon *icon,
                                        GdkRectangle *area)
 {
+    XfdesktopGridSegment *seg;
     gint16 row, col;
 
     if(!xfdesktop_icon_get_position(icon, &row, &col)) {
@@ -2813,8 +3509,16 @@ xfdesktop_icon_view_shift_area_to_cell(XfdesktopIconView *icon_view,
         return FALSE;
     }
 
-    area->x = icon_view->priv->xorigin + icon_view->priv->xmargin + col * CELL_SIZE + col * icon_view->priv->xspacing;
-    area->y = icon_view->priv->yorigin + icon_view->priv->ymargin + row * CELL_SIZE + row * icon_view->priv->yspacing;
+    seg = xfdesktop_grid_segment_for_col(icon_view, col);
+    if(!seg) {
+        g_warning("icon '%s' is in column %d, which isn't on any monitor",
+                  xfdesktop_icon_peek_label(icon), col);
+        return FALSE;
+    }
+    col -= seg->first_col;
+
+    area->x = seg->area.x + seg->xmargin + col * CELL_SIZE + col * seg->xspacing;
+    area->y = seg->area.y + seg->ymargin + row * CELL_SIZE + row * seg->yspacing;
 
     return TRUE;
 }
@@ -2871,22 +3575,125 @@ xfdesktop_icon_view_update_icon_extents(XfdesktopIconView *icon_view,
 }
 
 static void
-xfdesktop_icon_view_draw_image(cairo_t *cr, GdkPixbuf *pix, GdkRectangle *rect)
+xfdesktop_icon_view_draw_image(cairo_t *cr,
+                               cairo_surface_t *surface,
+                               GdkRectangle *rect)
 {
     cairo_save(cr);
 
-    gdk_cairo_set_source_pixbuf(cr, pix, rect->x, rect->y);
+    /* the surface carries its own device scale, so this is a straight
+     * copy rather than a resample */
+    cairo_set_source_surface(cr, surface, rect->x, rect->y);
     cairo_paint(cr);
 
     cairo_restore(cr);
 }
 
 static void
-xfdesktop_icon_view_draw_text(GtkWidget *icon_view, cairo_t *cr,
+xfdesktop_label_mask_free(XfdesktopLabelMask *label_mask)
+{
+    g_free(label_mask->key);
+    cairo_surface_destroy(label_mask->mask);
+    g_free(label_mask);
+}
+
+static void
+xfdesktop_icon_view_clear_label_masks(XfdesktopIconView *icon_view)
+{
+    XfdesktopLabelMask *label_mask;
+
+    g_hash_table_remove_all(icon_view->priv->label_mask_links);
+
+    while((label_mask = g_queue_pop_head(&icon_view->priv->label_masks)))
+        xfdesktop_label_mask_free(label_mask);
+
+    icon_view->priv->label_masks_size = 0;
+}
+
+/* Returns the text of @playout rendered as an alpha mask the size of
+ * @text_area, rendering it only if no icon with the same text laid out
+ * the same way has had it rendered recently. */
+static cairo_surface_t *
+xfdesktop_icon_view_get_label_mask(XfdesktopIconView *icon_view,
+                                   PangoLayout *playout,
+                                   GdkRectangle *text_area)
+{
+    XfdesktopLabelMask *label_mask;
+    GdkWindow *window;
+    GList *link;
+    gchar *key;
+    gint scale;
+    cairo_t *cr;
+
+    window = gtk_widget_get_window(GTK_WIDGET(icon_view));
+    if(!window || text_area->width <= 0 || text_area->height <= 0)
+        return NULL;
+
+    scale = gdk_window_get_scale_factor(window);
+
+    /* the font and alignment are the same for every label, and the
+     * cache is cleared when they change */
+    key = g_strdup_printf("%dx%d@%d %d %d %s",
+                          text_area->width, text_area->height, scale,
+                          pango_layout_get_width(playout),
+                          pango_layout_get_ellipsize(playout),
+                          pango_layout_get_text(playout));
+
+    link = g_hash_table_lookup(icon_view->priv->label_mask_links, key);
+    if(link) {
+        g_free(key);
+
+        /* most recently used goes to the front */
+        g_queue_unlink(&icon_view->priv->label_masks, link);
+        g_queue_push_head_link(&icon_view->priv->label_masks, link);
+
+        return ((XfdesktopLabelMask *)link->data)->mask;
+    }
+
+    label_mask = g_new0(XfdesktopLabelMask, 1);
+    label_mask->key = key;
+    /* picks up the window's scale factor, so the text stays crisp */
+    label_mask->mask = gdk_window_create_similar_surface(window,
+                                                         CAIRO_CONTENT_ALPHA,
+                                                         text_area->width,
+                                                         text_area->height);
+    label_mask->size = (gsize)text_area->width * text_area->height * scale * scale;
+
+    cr = cairo_create(label_mask->mask);
+    pango_cairo_show_layout(cr, playout);
+    cairo_destroy(cr);
+
+    g_queue_push_head(&icon_view->priv->label_masks, label_mask);
+    g_hash_table_insert(icon_view->priv->label_mask_links, label_mask->key,
+                        icon_view->priv->label_masks.head);
+    icon_view->priv->label_masks_size += label_mask->size;
+
+    /* evict the least recently used ones, but always keep the newest */
+    while(icon_view->priv->label_masks_size > LABEL_CACHE_SIZE
+          && icon_view->priv->label_masks.length > 1)
+    {
+        XfdesktopLabelMask *old = g_queue_pop_tail(&icon_view->priv->label_masks);
+
+        g_hash_table_remove(icon_view->priv->label_mask_links, old->key);
+        icon_view->priv->label_masks_size -= old->size;
+        xfdesktop_label_mask_free(old);
+    }
+
+    return label_mask->mask;
+}
+
+/* The label's background is themed and cheap, so it's drawn every time;
+ * the text, which is where the time goes, comes from the shared mask
+ * cache and is painted in the label's color for @state. */
+static void
+xfdesktop_icon_view_draw_text(XfdesktopIconView *icon_view,
+                              XfdesktopIcon *icon, cairo_t *cr,
                               PangoLayout *playout, GdkRectangle *text_area,
                               GdkRectangle *box_area, GtkStateFlags state)
 {
     GtkStyleContext *context;
+    cairo_surface_t *mask;
+    GdkRGBA color;
 
     cairo_save(cr);
 
@@ -2894,16 +3701,24 @@ xfdesktop_icon_view_draw_text(GtkWidget *icon_view, cairo_t *cr,
     gdk_cairo_rectangle(cr, box_area);
     cairo_clip(cr);
 
-    context = gtk_widget_get_style_context(icon_view);
+    context = gtk_widget_get_style_context(GTK_WIDGET(icon_view));
     gtk_style_context_save(context);
     gtk_style_context_add_class(context, GTK_STYLE_CLASS_LABEL);
     gtk_style_context_set_state (context, state);
 
     gtk_render_background(context, cr, box_area->x, box_area->y, box_area->width, box_area->height);
-    gtk_render_layout(context, cr, text_area->x, text_area->y, playout);
+
+    mask = xfdesktop_icon_view_get_label_mask(icon_view, playout, text_area);
+    if(mask) {
+        gtk_style_context_get_color(context, state, &color);
+        gdk_cairo_set_source_rgba(cr, &color);
+        cairo_mask_surface(cr, mask, text_area->x, text_area->y);
+    } else
+        gtk_render_layout(context, cr, text_area->x, text_area->y, playout);
 
     gtk_style_context_remove_class(context, GTK_STYLE_CLASS_LABEL);
     gtk_style_context_restore(context);
+
     cairo_restore(cr);
 }
 
@@ -2918,6 +3733,7 @@ xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
     GdkRectangle pixbuf_extents, text_extents, box_extents, total_extents;
     GdkRectangle intersection;
     GtkStateFlags state;
+    gint scale;
 #ifdef G_ENABLE_DEBUG
     gint16 row, col;
 #endif
@@ -2926,14 +3742,19 @@ xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
           area->width, area->height, area->x, area->y);
 
     playout = icon_view->priv->playout;
+    scale = gtk_widget_get_scale_factor(widget);
 
     cr = cairo_reference(cr);
     
+    /* this is where the image gets loaded, and only if it's actually going
+     * to be painted; after that its real size is used for the extents */
     if(!xfdesktop_icon_get_extents(icon, &pixbuf_extents,
                                    &text_extents, &total_extents))
     {
         g_warning("Can't get extents for icon '%s'", xfdesktop_icon_peek_label(icon));
-    }
+        xfdesktop_icon_peek_pixbuf(icon, ICON_WIDTH, ICON_SIZE, scale);
+    } else if(gdk_rectangle_intersect(area, &pixbuf_extents, NULL))
+        xfdesktop_icon_peek_pixbuf(icon, ICON_WIDTH, ICON_SIZE, scale);
 
     if(!xfdesktop_icon_view_update_icon_extents(icon_view, icon,
                                                 &pixbuf_extents,
@@ -2954,10 +3775,11 @@ xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
         state = GTK_STATE_FLAG_NORMAL;
     
     if(gdk_rectangle_intersect(area, &pixbuf_extents, &intersection)) {
-        GdkPixbuf *pix = xfdesktop_icon_peek_pixbuf(icon, ICON_WIDTH, ICON_SIZE);
+        GdkPixbuf *pix = xfdesktop_icon_peek_pixbuf(icon, ICON_WIDTH, ICON_SIZE, scale);
         GdkPixbuf *pix_free = NULL;
+        cairo_surface_t *surface = NULL;
 
-        if(state != GTK_STATE_FLAG_NORMAL) {
+        if(pix && state != GTK_STATE_FLAG_NORMAL) {
             GtkStyleContext *context;
             GdkRGBA rgba;
             GdkColor color;
@@ -2973,7 +3795,7 @@ xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
             pix = pix_free;
         }
 
-        if(icon_view->priv->item_under_pointer == icon) {
+        if(pix && icon_view->priv->item_under_pointer == icon) {
             GdkPixbuf *tmp = exo_gdk_pixbuf_spotlight(pix);
             if(pix_free)
                 g_object_unref(G_OBJECT(pix_free));
@@ -2993,10 +3815,24 @@ xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
         }
 #endif
 
-        xfdesktop_icon_view_draw_image(cr, pix, &pixbuf_extents);
-        
-        if(pix_free)
+        /* plain icons are painted from the surface the icon keeps; the
+         * highlighted ones are one-offs */
+        if(pix_free) {
+            surface = gdk_cairo_surface_create_from_pixbuf(pix_free, scale,
+                                                           gtk_widget_get_window(widget));
             g_object_unref(G_OBJECT(pix_free));
+        } else if(pix) {
+            surface = cairo_surface_reference(xfdesktop_icon_peek_surface(icon,
+                                                                          ICON_WIDTH,
+                                                                          ICON_SIZE,
+                                                                          scale,
+                                                                          gtk_widget_get_window(widget)));
+        }
+
+        if(surface) {
+            xfdesktop_icon_view_draw_image(cr, surface, &pixbuf_extents);
+            cairo_surface_destroy(surface);
+        }
     }
 
     /* Only redraw the text if the text area requires it. */
@@ -3007,7 +3843,7 @@ xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
               text_extents.width, text_extents.height,
               text_extents.x, text_extents.y);
 
-        xfdesktop_icon_view_draw_text(GTK_WIDGET(icon_view), cr, playout,
+        xfdesktop_icon_view_draw_text(icon_view, icon, cr, playout,
                                       &text_extents, &box_extents,
                                       state);
     }
@@ -3077,10 +3913,9 @@ xfdesktop_move_all_icons_to_pending_icons_list(XfdesktopIconView *icon_view)
     icon_view->priv->pending_icons = g_list_concat(icon_view->priv->icons,
                                                    icon_view->priv->pending_icons);
     icon_view->priv->icons = NULL;
+    g_hash_table_remove_all(icon_view->priv->invalidated_icons);
 
-    memset(icon_view->priv->grid_layout, 0,
-           (guint)icon_view->priv->nrows * icon_view->priv->ncols
-           * sizeof(XfdesktopIcon *));
+    xfdesktop_grid_clear(icon_view);
     
     xfdesktop_setup_grids(icon_view);
 }
@@ -3215,56 +4050,129 @@ xfdesktop_move_all_pending_icons_to_desktop(XfdesktopIconView *icon_view)
     xfdesktop_append_all_pending_icons(icon_view);
 }
 
-static void
-xfdesktop_grid_do_resize(XfdesktopIconView *icon_view)
+/* finds the new segment that takes over the cells of @old_seg, or -1 if
+ * its icons have to be placed again */
+static gint
+xfdesktop_grid_match_segment(XfdesktopIconView *icon_view,
+                             gint old_index,
+                             XfdesktopGridSegment *new_segments,
+                             gint n_new)
 {
-    gint xorigin = 0, yorigin = 0, width = 0, height = 0;
-    gint16 new_rows, new_cols;
-    gsize old_size, new_size;
-    GdkScreen *gscreen;
+    XfdesktopGridSegment *old_seg = &icon_view->priv->segments[old_index];
+    gint i;
 
-    /* First check to see if the grid actaully did change. This way
-     * we don't remove all the icons just to put them back again */
-    old_size = (guint)icon_view->priv->nrows * icon_view->priv->ncols
-               * sizeof(XfdesktopIcon *);
+    /* same monitor, same cells */
+    for(i = 0; i < n_new; ++i) {
+        if(xfdesktop_grid_segment_equal(old_seg, &new_segments[i]))
+            return i;
+    }
 
-    if(!xfdesktop_get_workarea_single(icon_view, 0,
-                                      &xorigin, &yorigin,
-                                      &width, &height))
+    /* otherwise, as long as the monitor count didn't change, a segment
+     * with the same number of cells just moved (e.g. a panel was added) */
+    if(n_new == icon_view->priv->n_segments
+       && new_segments[old_index].nrows == old_seg->nrows
+       && new_segments[old_index].ncols == old_seg->ncols)
     {
-        gscreen = gtk_widget_get_screen(GTK_WIDGET(icon_view));
-        width = gdk_screen_get_width(gscreen);
-        height = gdk_screen_get_height(gscreen);
+        return old_index;
     }
 
-    new_rows = (height - MIN_MARGIN * 2) / CELL_SIZE;
-    new_cols = (width - MIN_MARGIN * 2) / CELL_SIZE;
+    return -1;
+}
 
-    new_size = (guint)new_rows * new_cols * sizeof(XfdesktopIcon *);
+static void
+xfdesktop_grid_do_resize(XfdesktopIconView *icon_view)
+{
+    XfdesktopGridSegment *new_segments;
+    gint n_new, i, *seg_map;
+    gboolean unchanged;
+    GList *l, *next;
+
+    new_segments = xfdesktop_grid_compute_segments(icon_view, &n_new);
+
+    /* First check which segments actually did change. This way we don't
+     * remove all the icons just to put them back again */
+    seg_map = g_new(gint, MAX(icon_view->priv->n_segments, 1));
+    unchanged = (n_new == icon_view->priv->n_segments);
+    for(i = 0; i < icon_view->priv->n_segments; ++i) {
+        seg_map[i] = xfdesktop_grid_match_segment(icon_view, i,
+                                                  new_segments, n_new);
+        if(seg_map[i] != i)
+            unchanged = FALSE;
+    }
 
-    if(old_size != new_size) {
-        DBG("old_size != new_size use cache icon list");
+    if(!unchanged) {
+        DBG("grid segments changed, relaying out the ones that need it");
         #if 0 /*def DEBUG*/
             DUMP_GRID_LAYOUT(icon_view);
         #endif
 
-        /* Grid size did change */
-        xfdesktop_move_all_icons_to_pending_icons_list(icon_view);
+        /* icons on segments that are still there keep their cell and only
+         * follow the segment's new first column; the others go back to
+         * the pending list and get placed like after any other resize */
+        for(l = icon_view->priv->icons; l; l = next) {
+            XfdesktopIcon *icon = XFDESKTOP_ICON(l->data);
+            XfdesktopGridSegment *seg = NULL;
+            gint16 row, col;
+
+            next = l->next;
+
+            if(xfdesktop_icon_get_position(icon, &row, &col))
+                seg = xfdesktop_grid_segment_for_col(icon_view, col);
+
+            if(seg && seg_map[seg - icon_view->priv->segments] >= 0) {
+                XfdesktopGridSegment *new_seg = &new_segments[seg_map[seg - icon_view->priv->segments]];
+
+                xfdesktop_icon_set_position(icon, row,
+                                            new_seg->first_col + col - seg->first_col);
+                continue;
+            }
+
+            g_signal_handlers_disconnect_by_func(G_OBJECT(icon),
+                                                 G_CALLBACK(xfdesktop_icon_view_icon_changed),
+                                                 icon_view);
+            g_hash_table_remove(icon_view->priv->invalidated_icons, icon);
+            icon_view->priv->icons = g_list_remove_link(icon_view->priv->icons, l);
+            icon_view->priv->pending_icons = g_list_concat(l, icon_view->priv->pending_icons);
+        }
+
+        xfdesktop_grid_clear(icon_view);
+        xfdesktop_setup_grids_with_segments(icon_view, new_segments, n_new);
+        new_segments = NULL;
+
+        for(l = icon_view->priv->icons; l; l = next) {
+            next = l->next;
+
+            if(xfdesktop_grid_unset_position_free(icon_view, l->data)) {
+                xfdesktop_icon_view_invalidate_icon(icon_view, l->data, TRUE);
+            } else {
+                g_signal_handlers_disconnect_by_func(G_OBJECT(l->data),
+                                                     G_CALLBACK(xfdesktop_icon_view_icon_changed),
+                                                     icon_view);
+                icon_view->priv->icons = g_list_remove_link(icon_view->priv->icons, l);
+                icon_view->priv->pending_icons = g_list_concat(l, icon_view->priv->pending_icons);
+            }
+        }
+
+        /* Fire off an event to notify others of the change; this goes
+         * first so the manager has picked up the new workarea before we
+         * ask it where the pending icons were last placed */
+        g_signal_emit(G_OBJECT(icon_view), __signals[SIG_RESIZE_EVENT], 0, NULL);
+
         xfdesktop_move_all_pending_icons_to_desktop(icon_view);
 
         #if 0 /*def DEBUG*/
             DUMP_GRID_LAYOUT(icon_view);
         #endif
-
-        /* Fire off an event to notify others of the change */
-        g_signal_emit(G_OBJECT(icon_view), __signals[SIG_RESIZE_EVENT], 0, NULL);
     }
     else {
-        DBG("old_size == new_size updating grid");
-        xfdesktop_setup_grids (icon_view);
+        DBG("segments unchanged, updating grid");
+        xfdesktop_setup_grids_with_segments(icon_view, new_segments, n_new);
+        new_segments = NULL;
     }
 
-    gtk_widget_queue_draw(GTK_WIDGET(icon_view));
+    g_free(seg_map);
+
+    xfdesktop_icon_view_queue_draw(icon_view);
 }
 
 static gboolean
@@ -3359,11 +4267,148 @@ xfdesktop_get_workarea_single(XfdesktopIconView *icon_view,
     return ret;
 }
 
+static inline gint
+xfdesktop_grid_ctz(gulong word)
+{
+#if defined(__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4))
+    return __builtin_ctzl(word);
+#else
+    gint n = 0;
+
+    while(!(word & 1)) {
+        word >>= 1;
+        ++n;
+    }
+
+    return n;
+#endif
+}
+
+static inline gint
+xfdesktop_grid_clz(gulong word)
+{
+#if defined(__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4))
+    return __builtin_clzl(word);
+#else
+    gint n = 0;
+
+    while(!(word & (1UL << (GRID_WORD_BITS - 1)))) {
+        word <<= 1;
+        ++n;
+    }
+
+    return n;
+#endif
+}
+
+/* returns the first bit at or after @start that is set in @bits but not in
+ * @mask (which may be NULL), or -1 */
+static gint
+xfdesktop_grid_bits_next(const gulong *bits,
+                         const gulong *mask,
+                         gint start,
+                         gint n_bits)
+{
+    gint i, n_words;
+    gulong word;
+
+    if(start < 0 || start >= n_bits)
+        return -1;
+
+    n_words = GRID_N_WORDS((guint)n_bits);
+    i = GRID_WORD(start);
+    word = bits[i] & ~(mask ? mask[i] : 0) & ~(GRID_BIT(start) - 1);
+
+    for(;;) {
+        if(word) {
+            gint idx = i * GRID_WORD_BITS + xfdesktop_grid_ctz(word);
+            return idx < n_bits ? idx : -1;
+        }
+
+        if(++i >= n_words)
+            return -1;
+        word = bits[i] & ~(mask ? mask[i] : 0);
+    }
+}
+
+/* like xfdesktop_grid_bits_next(), but for the last bit at or before
+ * @start */
+static gint
+xfdesktop_grid_bits_prev(const gulong *bits,
+                         const gulong *mask,
+                         gint start)
+{
+    gint i;
+    gulong word;
+
+    if(start < 0)
+        return -1;
+
+    i = GRID_WORD(start);
+    /* wraps around to all ones when start is the word's top bit */
+    word = bits[i] & ~(mask ? mask[i] : 0) & ((GRID_BIT(start) << 1) - 1);
+
+    for(;;) {
+        if(word)
+            return (i + 1) * GRID_WORD_BITS - 1 - xfdesktop_grid_clz(word);
+
+        if(--i < 0)
+            return -1;
+        word = bits[i] & ~(mask ? mask[i] : 0);
+    }
+}
+
+/* recomputes grid_used and grid_by_row from grid_layout and grid_dead */
+static void
+xfdesktop_grid_rebuild_used(XfdesktopIconView *icon_view)
+{
+    gint i, n_cells;
+
+    n_cells = icon_view->priv->nrows * icon_view->priv->ncols;
+    if(n_cells <= 0 || icon_view->priv->grid_layout == NULL)
+        return;
+
+    memcpy(icon_view->priv->grid_used, icon_view->priv->grid_dead,
+           GRID_N_WORDS((guint)n_cells) * sizeof(gulong));
+    memset(icon_view->priv->grid_by_row, 0,
+           GRID_N_WORDS((guint)n_cells) * sizeof(gulong));
+
+    for(i = 0; i < n_cells; ++i) {
+        if(icon_view->priv->grid_layout[i]) {
+            gint by_row = (i % icon_view->priv->nrows) * icon_view->priv->ncols
+                          + i / icon_view->priv->nrows;
+
+            icon_view->priv->grid_used[GRID_WORD(i)] |= GRID_BIT(i);
+            icon_view->priv->grid_by_row[GRID_WORD(by_row)] |= GRID_BIT(by_row);
+        }
+    }
+
+    icon_view->priv->grid_first_free = 0;
+}
+
+/* empties every cell, but keeps the dead ones dead */
+static void
+xfdesktop_grid_clear(XfdesktopIconView *icon_view)
+{
+    guint n_cells = (guint)icon_view->priv->nrows * icon_view->priv->ncols;
+
+    if(icon_view->priv->grid_layout == NULL)
+        return;
+
+    memset(icon_view->priv->grid_layout, 0, n_cells * sizeof(XfdesktopIcon *));
+    memcpy(icon_view->priv->grid_used, icon_view->priv->grid_dead,
+           GRID_N_WORDS(n_cells) * sizeof(gulong));
+    memset(icon_view->priv->grid_by_row, 0, GRID_N_WORDS(n_cells) * sizeof(gulong));
+    icon_view->priv->grid_first_free = 0;
+}
+
 static inline gboolean
 xfdesktop_grid_is_free_position(XfdesktopIconView *icon_view,
                                 gint16 row,
                                 gint16 col)
 {
+    gint idx;
+
     if(icon_view->priv->grid_layout == NULL) {
         return FALSE;
     }
@@ -3372,8 +4417,9 @@ xfdesktop_grid_is_free_position(XfdesktopIconView *icon_view,
     {
         return FALSE;
     }
-    
-    return !icon_view->priv->grid_layout[col * icon_view->priv->nrows + row];
+
+    idx = col * icon_view->priv->nrows + row;
+    return !(icon_view->priv->grid_used[GRID_WORD(idx)] & GRID_BIT(idx));
 }
 
 
@@ -3382,18 +4428,45 @@ xfdesktop_grid_get_next_free_position(XfdesktopIconView *icon_view,
                                       gint16 *row,
                                       gint16 *col)
 {
-    gint i, maxi;
+    gint i, n_cells, n_words;
+    gulong word;
     
     g_return_val_if_fail(row && col, FALSE);
     
-    maxi = icon_view->priv->nrows * icon_view->priv->ncols;
-    for(i = 0; i < maxi; ++i) {
-        if(!icon_view->priv->grid_layout[i]) {
-            *row = i % icon_view->priv->nrows;
-            *col = i / icon_view->priv->nrows;
+    n_cells = icon_view->priv->nrows * icon_view->priv->ncols;
+    if(icon_view->priv->grid_layout == NULL
+       || icon_view->priv->grid_first_free >= n_cells)
+    {
+        return FALSE;
+    }
+
+    n_words = GRID_N_WORDS((guint)n_cells);
+    i = GRID_WORD(icon_view->priv->grid_first_free);
+
+    /* ignore the cells in the first word that lie before the hint */
+    word = ~icon_view->priv->grid_used[i]
+           & ~(GRID_BIT(icon_view->priv->grid_first_free) - 1);
+
+    for(;;) {
+        if(word) {
+            gint idx = i * GRID_WORD_BITS + xfdesktop_grid_ctz(word);
+
+            /* the tail of the last word is past the end of the grid */
+            if(idx >= n_cells)
+                break;
+
+            icon_view->priv->grid_first_free = idx;
+            *row = idx % icon_view->priv->nrows;
+            *col = idx / icon_view->priv->nrows;
             return TRUE;
         }
+
+        if(++i >= n_words)
+            break;
+        word = ~icon_view->priv->grid_used[i];
     }
+
+    icon_view->priv->grid_first_free = n_cells;
     
     return FALSE;
 }
@@ -3404,6 +4477,8 @@ xfdesktop_grid_set_position_free(XfdesktopIconView *icon_view,
                                  gint16 row,
                                  gint16 col)
 {
+    gint idx, by_row;
+
     g_return_if_fail(row < icon_view->priv->nrows
                      && col < icon_view->priv->ncols);
     
@@ -3411,7 +4486,17 @@ xfdesktop_grid_set_position_free(XfdesktopIconView *icon_view,
     DUMP_GRID_LAYOUT(icon_view);
 #endif
 
-    icon_view->priv->grid_layout[col * icon_view->priv->nrows + row] = NULL;
+    idx = col * icon_view->priv->nrows + row;
+    icon_view->priv->grid_layout[idx] = NULL;
+
+    by_row = row * icon_view->priv->ncols + col;
+    icon_view->priv->grid_by_row[GRID_WORD(by_row)] &= ~GRID_BIT(by_row);
+
+    if(!(icon_view->priv->grid_dead[GRID_WORD(idx)] & GRID_BIT(idx))) {
+        icon_view->priv->grid_used[GRID_WORD(idx)] &= ~GRID_BIT(idx);
+        if(idx < icon_view->priv->grid_first_free)
+            icon_view->priv->grid_first_free = idx;
+    }
 
 #if 0 /*def DEBUG*/
     DUMP_GRID_LAYOUT(icon_view);
@@ -3424,13 +4509,13 @@ xfdesktop_grid_unset_position_free_raw(XfdesktopIconView *icon_view,
                                        gint16 col,
                                        gpointer data)
 {
-    gint idx;
+    gint idx, by_row;
     
     g_return_val_if_fail(row < icon_view->priv->nrows
                          && col < icon_view->priv->ncols, FALSE);
     
     idx = col * icon_view->priv->nrows + row;
-    if(icon_view->priv->grid_layout[idx])
+    if(icon_view->priv->grid_used[GRID_WORD(idx)] & GRID_BIT(idx))
         return FALSE;
 
 #if 0 /*def DEBUG*/
@@ -3438,6 +4523,10 @@ xfdesktop_grid_unset_position_free_raw(XfdesktopIconView *icon_view,
 #endif
 
     icon_view->priv->grid_layout[idx] = data;
+    icon_view->priv->grid_used[GRID_WORD(idx)] |= GRID_BIT(idx);
+
+    by_row = row * icon_view->priv->ncols + col;
+    icon_view->priv->grid_by_row[GRID_WORD(by_row)] |= GRID_BIT(by_row);
 
 #if 0 /*def DEBUG*/
     DUMP_GRID_LAYOUT(icon_view);
@@ -3464,12 +4553,7 @@ static inline XfdesktopIcon *
 xfdesktop_icon_view_icon_in_cell_raw(XfdesktopIconView *icon_view,
                                      gint idx)
 {
-    XfdesktopIcon *icon = icon_view->priv->grid_layout[idx];
-    
-    if((gpointer)0xdeadbeef == icon)
-        return NULL;
-    
-    return icon;
+    return icon_view->priv->grid_layout[idx];
 }
 
 static inline XfdesktopIcon *
@@ -3549,6 +4633,8 @@ static void
 xfdesktop_icon_view_icon_changed(XfdesktopIcon *icon,
                                  gpointer user_data)
 {
+    xfdesktop_icon_view_drop_tooltip_pixbuf(XFDESKTOP_ICON_VIEW(user_data), icon);
+
     /* maybe can pass FALSE here */
     xfdesktop_icon_view_invalidate_icon(XFDESKTOP_ICON_VIEW(user_data),
                                         icon, TRUE);
@@ -3594,6 +4680,12 @@ xfdesktop_icon_view_new(XfdesktopIconViewManager *manager)
                            G_TYPE_DOUBLE,
                            G_OBJECT(icon_view),
                            "tooltip_size");
+
+    xfconf_g_property_bind(icon_view->priv->channel,
+                           "/desktop-icons/retained-layer",
+                           G_TYPE_BOOLEAN,
+                           G_OBJECT(icon_view),
+                           "retained_layer");
     
     return GTK_WIDGET(icon_view);
 }
@@ -3603,13 +4695,6 @@ xfdesktop_icon_view_add_item_internal(XfdesktopIconView *icon_view,
                                       XfdesktopIcon *icon)
 {
     gint16 row, col;
-    cairo_rectangle_int_t fake_area;
-#if 0 /* GTK_CHECK_VERSION (3, 22, 0) */
-    GdkDrawingContext *gdc;
-#endif
-    cairo_region_t *region;
-    cairo_t *cr;
-    GdkWindow *gdkwindow;
     
     /* sanity check: at this point this should be taken care of */
     if(!xfdesktop_icon_get_position(icon, &row, &col)) {
@@ -3628,34 +4713,9 @@ xfdesktop_icon_view_add_item_internal(XfdesktopIconView *icon_view,
                      G_CALLBACK(xfdesktop_icon_view_icon_changed),
                      icon_view);
 
-    gdkwindow = gtk_widget_get_window(GTK_WIDGET(icon_view));
-
-    /* Calculate the region the icon will occupy */
-    fake_area.x = icon_view->priv->xorigin + icon_view->priv->xmargin + col * CELL_SIZE + col * icon_view->priv->xspacing;
-    fake_area.y = icon_view->priv->yorigin + icon_view->priv->ymargin + row * CELL_SIZE + row * icon_view->priv->yspacing;
-    fake_area.width = fake_area.height = CELL_SIZE;
-
-    /* Pack it into a cairo region to tell gdk that's where we will be painting */
-    region = cairo_region_create_rectangle(&fake_area);
-#if 0 /* GTK_CHECK_VERSION (3, 22, 0) */
-    gdc = gdk_window_begin_draw_frame(gdkwindow, region);
-    cr = gdk_drawing_context_get_cairo_context(gdc);
-#else
-    cr = gdk_cairo_create(gdkwindow);
-#endif
-
-    /* paint the icon */
-    xfdesktop_icon_view_paint_icon(icon_view, icon, &fake_area, cr);
-
-#if 0 /* GTK_CHECK_VERSION (3, 22, 0) */
-    /* we're done drawing */
-    gdk_window_end_draw_frame(gdkwindow, gdc);
-#else
-    /* we're done drawing */
-    cairo_destroy(cr);
-#endif
-
-    cairo_region_destroy(region);
+    /* the icon gets painted along with everything else that was
+     * invalidated during this frame */
+    xfdesktop_icon_view_invalidate_icon(icon_view, icon, TRUE);
 }
 
 static gboolean
@@ -3680,15 +4740,12 @@ xfdesktop_icon_view_icon_find_position(XfdesktopIconView *icon_view,
     return TRUE;
 }
 
-void
-xfdesktop_icon_view_add_item(XfdesktopIconView *icon_view,
-                             XfdesktopIcon *icon)
+static void
+xfdesktop_icon_view_add_item_real(XfdesktopIconView *icon_view,
+                                  XfdesktopIcon *icon)
 {
     gint16 row, col;
     
-    g_return_if_fail(XFDESKTOP_IS_ICON_VIEW(icon_view)
-                     && XFDESKTOP_IS_ICON(icon));
-    
     /* ensure the icon isn't already in an icon view */
     g_return_if_fail(!g_object_get_data(G_OBJECT(icon),
                                         "--xfdesktop-icon-view"));
@@ -3716,6 +4773,35 @@ xfdesktop_icon_view_add_item(XfdesktopIconView *icon_view,
     }
 }
 
+void
+xfdesktop_icon_view_add_item(XfdesktopIconView *icon_view,
+                             XfdesktopIcon *icon)
+{
+    g_return_if_fail(XFDESKTOP_IS_ICON_VIEW(icon_view)
+                     && XFDESKTOP_IS_ICON(icon));
+
+    xfdesktop_icon_view_add_item_real(icon_view, icon);
+}
+
+/* Adds all the icons in @icons, in order.  Nothing is painted until the
+ * next frame, so the whole batch ends up in a single redraw. */
+void
+xfdesktop_icon_view_add_items(XfdesktopIconView *icon_view,
+                              GList *icons)
+{
+    GList *l;
+
+    g_return_if_fail(XFDESKTOP_IS_ICON_VIEW(icon_view));
+
+    /* check them all first, so a bad entry doesn't leave half the list
+     * added */
+    for(l = icons; l; l = l->next)
+        g_return_if_fail(XFDESKTOP_IS_ICON(l->data));
+
+    for(l = icons; l; l = l->next)
+        xfdesktop_icon_view_add_item_real(icon_view, XFDESKTOP_ICON(l->data));
+}
+
 void
 xfdesktop_icon_view_remove_item(XfdesktopIconView *icon_view,
                                 XfdesktopIcon *icon)
@@ -3736,6 +4822,7 @@ xfdesktop_icon_view_remove_item(XfdesktopIconView *icon_view,
             xfdesktop_icon_view_invalidate_icon(icon_view, icon, FALSE);
             xfdesktop_grid_set_position_free(icon_view, row, col);
         }
+        g_hash_table_remove(icon_view->priv->invalidated_icons, icon);
         icon_view->priv->icons = g_list_delete_link(icon_view->priv->icons, l);
         icon_view->priv->selected_icons = g_list_remove(icon_view->priv->selected_icons,
                                                         icon);
@@ -3757,6 +4844,10 @@ xfdesktop_icon_view_remove_item(XfdesktopIconView *icon_view,
         return;
     }
     
+    xfdesktop_icon_view_drop_tooltip_pixbuf(icon_view, icon);
+    /* another icon may get the same address */
+    g_hash_table_remove(icon_view->priv->tooltip_no_image, icon);
+
     g_object_set_data(G_OBJECT(icon), "--xfdesktop-icon-view", NULL);
     g_object_unref(G_OBJECT(icon));
 
@@ -3773,6 +4864,8 @@ xfdesktop_icon_view_remove_all(XfdesktopIconView *icon_view)
     gint16 row, col;
     
     g_return_if_fail(XFDESKTOP_IS_ICON_VIEW(icon_view));
+
+    xfdesktop_icon_view_clear_tooltip_pixbufs(icon_view);
     
     if(icon_view->priv->pending_icons) {
         g_list_foreach(icon_view->priv->pending_icons, (GFunc)g_object_unref,
@@ -3799,6 +4892,11 @@ xfdesktop_icon_view_remove_all(XfdesktopIconView *icon_view)
         g_list_free(icon_view->priv->icons);
         icon_view->priv->icons = NULL;
     }
+
+    /* the old extents are already queued, but there's nothing left
+     * to recalculate */
+    g_hash_table_remove_all(icon_view->priv->invalidated_icons);
+    xfdesktop_icon_view_clear_label_masks(icon_view);
     
     if(icon_view->priv->selected_icons) {
         g_list_free(icon_view->priv->selected_icons);
@@ -4093,7 +5191,7 @@ xfdesktop_icon_view_set_icon_size(XfdesktopIconView *icon_view,
     
     if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
         xfdesktop_grid_do_resize(icon_view);
-        gtk_widget_queue_draw(GTK_WIDGET(icon_view));
+        xfdesktop_icon_view_queue_draw(icon_view);
     }
 }
 
@@ -4114,11 +5212,12 @@ xfdesktop_icon_view_set_font_size(XfdesktopIconView *icon_view,
         return;
     
     icon_view->priv->font_size = font_size_points;
+    xfdesktop_icon_view_clear_label_masks(icon_view);
     
     if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
         xfdesktop_icon_view_modify_font_size(icon_view, font_size_points);
         xfdesktop_grid_do_resize(icon_view);
-        gtk_widget_queue_draw(GTK_WIDGET(icon_view));
+        xfdesktop_icon_view_queue_draw(icon_view);
     }
 }
 
@@ -4139,9 +5238,10 @@ xfdesktop_icon_view_set_center_text (XfdesktopIconView *icon_view,
         return;
     
     icon_view->priv->center_text = center_text;
+    xfdesktop_icon_view_clear_label_masks(icon_view);
     
     if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
-        gtk_widget_queue_draw(GTK_WIDGET(icon_view));
+        xfdesktop_icon_view_queue_draw(icon_view);
     }
 }
 
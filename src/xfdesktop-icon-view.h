@@ -76,6 +76,8 @@ GtkWidget *xfdesktop_icon_view_new(XfdesktopIconViewManager *manager);
 
 void xfdesktop_icon_view_add_item(XfdesktopIconView *icon_view,
                                   XfdesktopIcon *icon);
+void xfdesktop_icon_view_add_items(XfdesktopIconView *icon_view,
+                                   GList *icons);
 
 void xfdesktop_icon_view_remove_item(XfdesktopIconView *icon_view,
                                      XfdesktopIcon *icon);
@@ -41,9 +41,11 @@ struct _XfdesktopIconPrivate
     GdkRectangle text_extents;
     GdkRectangle total_extents;
 
-    GdkPixbuf *pix, *tooltip_pix;
-    gint cur_pix_width, cur_pix_height;
-    gint cur_tooltip_pix_width, cur_tooltip_pix_height;
+    GdkPixbuf *pix;
+    cairo_surface_t *surface;
+    gint cur_pix_width, cur_pix_height, cur_pix_scale;
+
+    gchar *collate_key;
 };
 
 enum {
@@ -132,6 +134,7 @@ xfdesktop_icon_finalize(GObject *obj)
     XfdesktopIcon *icon = XFDESKTOP_ICON(obj);
 
     xfdesktop_icon_invalidate_pixbuf(icon);
+    g_free(icon->priv->collate_key);
 }
 
 void
@@ -193,30 +196,86 @@ xfdesktop_icon_get_extents(XfdesktopIcon *icon,
 }
 
 /*< required >*/
+/* @width and @height are in logical pixels; the pixbuf returned is
+ * @scale times that, in device pixels */
 GdkPixbuf *
 xfdesktop_icon_peek_pixbuf(XfdesktopIcon *icon,
-                           gint width, gint height)
+                           gint width, gint height,
+                           gint scale)
 {
     XfdesktopIconClass *klass;
     
-    g_return_val_if_fail(XFDESKTOP_IS_ICON(icon), NULL);
+    g_return_val_if_fail(XFDESKTOP_IS_ICON(icon) && scale > 0, NULL);
     klass = XFDESKTOP_ICON_GET_CLASS(icon);
     g_return_val_if_fail(klass->peek_pixbuf, NULL);
 
-    if(width != icon->priv->cur_pix_width || height != icon->priv->cur_pix_height)
+    if(width != icon->priv->cur_pix_width
+       || height != icon->priv->cur_pix_height
+       || scale != icon->priv->cur_pix_scale)
+    {
         xfdesktop_icon_invalidate_regular_pixbuf(icon);
+    }
 
     if(icon->priv->pix == NULL) {
         icon->priv->cur_pix_width = width;
         icon->priv->cur_pix_height = height;
+        icon->priv->cur_pix_scale = scale;
 
         /* Generate a new pixbuf */
-        icon->priv->pix = klass->peek_pixbuf(icon, width, height);
+        icon->priv->pix = klass->peek_pixbuf(icon, width, height, scale);
     }
 
     return icon->priv->pix;
 }
 
+/* Returns the pixbuf from xfdesktop_icon_peek_pixbuf() as a surface with
+ * its device scale set, so it can be painted at logical coordinates
+ * without being resampled.  Like the pixbuf, it's owned by the icon. */
+cairo_surface_t *
+xfdesktop_icon_peek_surface(XfdesktopIcon *icon,
+                            gint width, gint height,
+                            gint scale,
+                            GdkWindow *for_window)
+{
+    GdkPixbuf *pix;
+
+    pix = xfdesktop_icon_peek_pixbuf(icon, width, height, scale);
+    if(!pix)
+        return NULL;
+
+    if(!icon->priv->surface)
+        icon->priv->surface = gdk_cairo_surface_create_from_pixbuf(pix, scale, for_window);
+
+    return icon->priv->surface;
+}
+
+/* Gets the logical size of the pixbuf xfdesktop_icon_peek_pixbuf() would
+ * return, but only if it's already loaded; returns FALSE instead of
+ * loading it. */
+gboolean
+xfdesktop_icon_get_pixbuf_size(XfdesktopIcon *icon,
+                               gint width, gint height,
+                               gint scale,
+                               gint *pix_width, gint *pix_height)
+{
+    g_return_val_if_fail(XFDESKTOP_IS_ICON(icon) && scale > 0, FALSE);
+
+    if(icon->priv->pix == NULL
+       || width != icon->priv->cur_pix_width
+       || height != icon->priv->cur_pix_height
+       || scale != icon->priv->cur_pix_scale)
+    {
+        return FALSE;
+    }
+
+    if(pix_width)
+        *pix_width = (gdk_pixbuf_get_width(icon->priv->pix) + scale - 1) / scale;
+    if(pix_height)
+        *pix_height = (gdk_pixbuf_get_height(icon->priv->pix) + scale - 1) / scale;
+
+    return TRUE;
+}
+
 /*< required >*/
 const gchar *
 xfdesktop_icon_peek_label(XfdesktopIcon *icon)
@@ -230,6 +289,24 @@ xfdesktop_icon_peek_label(XfdesktopIcon *icon)
     return klass->peek_label(icon);
 }
 
+/* a key for sorting icons by label with strcmp(); it's only rebuilt after
+ * the label changes, see xfdesktop_icon_label_changed() */
+const gchar *
+xfdesktop_icon_peek_collate_key(XfdesktopIcon *icon)
+{
+    const gchar *label;
+
+    g_return_val_if_fail(XFDESKTOP_IS_ICON(icon), NULL);
+
+    if(icon->priv->collate_key == NULL) {
+        label = xfdesktop_icon_peek_label(icon);
+        icon->priv->collate_key = g_utf8_collate_key_for_filename(label ? label : "",
+                                                                  -1);
+    }
+
+    return icon->priv->collate_key;
+}
+
 /*< required >*/
 gchar *
 xfdesktop_icon_get_identifier(XfdesktopIcon *icon)
@@ -298,28 +375,49 @@ xfdesktop_icon_do_drop_dest(XfdesktopIcon *icon,
 }
 
 /*< optional >*/
-GdkPixbuf *
-xfdesktop_icon_peek_tooltip_pixbuf(XfdesktopIcon *icon,
-                                   gint width, gint height)
+/* Loads the tooltip image without keeping it around.  Classes whose images
+ * can be slow to load implement load_tooltip_pixbuf_async(), everything
+ * else is loaded right away through peek_tooltip_pixbuf(). */
+void
+xfdesktop_icon_load_tooltip_pixbuf_async(XfdesktopIcon *icon,
+                                         gint width,
+                                         gint height,
+                                         GCancellable *cancellable,
+                                         GAsyncReadyCallback callback,
+                                         gpointer user_data)
 {
     XfdesktopIconClass *klass;
+    GdkPixbuf *pix = NULL;
+    GTask *task;
 
-    g_return_val_if_fail(XFDESKTOP_IS_ICON(icon), NULL);
+    g_return_if_fail(XFDESKTOP_IS_ICON(icon));
     klass = XFDESKTOP_ICON_GET_CLASS(icon);
-    g_return_val_if_fail(klass->peek_tooltip_pixbuf, NULL);
 
-    if(width != icon->priv->cur_tooltip_pix_width || height != icon->priv->cur_tooltip_pix_height)
-        xfdesktop_icon_invalidate_tooltip_pixbuf(icon);
+    if(klass->load_tooltip_pixbuf_async) {
+        klass->load_tooltip_pixbuf_async(icon, width, height, cancellable,
+                                         callback, user_data);
+        return;
+    }
 
-    if(icon->priv->tooltip_pix == NULL) {
-        icon->priv->cur_tooltip_pix_width = width;
-        icon->priv->cur_tooltip_pix_height = height;
+    task = g_task_new(icon, cancellable, callback, user_data);
 
-        /* Generate a new pixbuf */
-        icon->priv->tooltip_pix = klass->peek_tooltip_pixbuf(icon, width, height);
-    }
+    if(klass->peek_tooltip_pixbuf)
+        pix = klass->peek_tooltip_pixbuf(icon, width, height);
+
+    g_task_return_pointer(task, pix, pix ? g_object_unref : NULL);
+    g_object_unref(task);
+}
+
+/* returns a new reference, or NULL if there's no image (in which case
+ * @error may or may not be set) */
+GdkPixbuf *
+xfdesktop_icon_load_tooltip_pixbuf_finish(XfdesktopIcon *icon,
+                                          GAsyncResult *result,
+                                          GError **error)
+{
+    g_return_val_if_fail(g_task_is_valid(result, icon), NULL);
 
-    return icon->priv->tooltip_pix;
+    return g_task_propagate_pointer(G_TASK(result), error);
 }
 
 /*< optional >*/
@@ -401,14 +499,10 @@ xfdesktop_icon_invalidate_regular_pixbuf(XfdesktopIcon *icon)
         g_object_unref(G_OBJECT(icon->priv->pix));
         icon->priv->pix = NULL;
     }
-}
 
-void
-xfdesktop_icon_invalidate_tooltip_pixbuf(XfdesktopIcon *icon)
-{
-    if(icon->priv->tooltip_pix) {
-        g_object_unref(G_OBJECT(icon->priv->tooltip_pix));
-        icon->priv->tooltip_pix = NULL;
+    if(icon->priv->surface) {
+        cairo_surface_destroy(icon->priv->surface);
+        icon->priv->surface = NULL;
     }
 }
 
@@ -416,7 +510,6 @@ void
 xfdesktop_icon_invalidate_pixbuf(XfdesktopIcon *icon)
 {
     xfdesktop_icon_invalidate_regular_pixbuf(icon);
-    xfdesktop_icon_invalidate_tooltip_pixbuf(icon);
 }
 
 /*< signal triggers >*/
@@ -432,6 +525,10 @@ void
 xfdesktop_icon_label_changed(XfdesktopIcon *icon)
 {
     g_return_if_fail(XFDESKTOP_IS_ICON(icon));
+
+    g_free(icon->priv->collate_key);
+    icon->priv->collate_key = NULL;
+
     g_signal_emit(icon, __signals[SIG_LABEL_CHANGED], 0);
 }
 
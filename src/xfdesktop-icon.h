@@ -63,7 +63,12 @@ struct _XfdesktopIconClass
     gboolean (*activated)(XfdesktopIcon *icon);
     
     /*< virtual functions >*/
-    GdkPixbuf *(*peek_pixbuf)(XfdesktopIcon *icon, gint width, gint height);
+    /* @width and @height are logical pixels; the pixbuf should be @scale
+     * times that size */
+    GdkPixbuf *(*peek_pixbuf)(XfdesktopIcon *icon,
+                              gint width,
+                              gint height,
+                              gint scale);
     const gchar *(*peek_label)(XfdesktopIcon *icon);
     
     GdkDragAction (*get_allowed_drag_actions)(XfdesktopIcon *icon);
@@ -72,6 +77,14 @@ struct _XfdesktopIconClass
     gboolean (*do_drop_dest)(XfdesktopIcon *icon, XfdesktopIcon *src_icon, GdkDragAction action);
 
     GdkPixbuf *(*peek_tooltip_pixbuf)(XfdesktopIcon *icon, gint width, gint height);
+    /* must complete a GTask with the icon as its source object, returning
+     * a new pixbuf reference as its pointer */
+    void (*load_tooltip_pixbuf_async)(XfdesktopIcon *icon,
+                                      gint width,
+                                      gint height,
+                                      GCancellable *cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data);
     const gchar *(*peek_tooltip)(XfdesktopIcon *icon);
 
     gchar *(*get_identifier)(XfdesktopIcon *icon);
@@ -89,11 +102,30 @@ GType xfdesktop_icon_get_type(void) G_GNUC_CONST;
 
 GdkPixbuf *xfdesktop_icon_peek_pixbuf(XfdesktopIcon *icon,
                                      gint width,
-                                     gint height);
+                                     gint height,
+                                     gint scale);
+cairo_surface_t *xfdesktop_icon_peek_surface(XfdesktopIcon *icon,
+                                             gint width,
+                                             gint height,
+                                             gint scale,
+                                             GdkWindow *for_window);
 const gchar *xfdesktop_icon_peek_label(XfdesktopIcon *icon);
-GdkPixbuf *xfdesktop_icon_peek_tooltip_pixbuf(XfdesktopIcon *icon,
+const gchar *xfdesktop_icon_peek_collate_key(XfdesktopIcon *icon);
+gboolean xfdesktop_icon_get_pixbuf_size(XfdesktopIcon *icon,
+                                        gint width,
+                                        gint height,
+                                        gint scale,
+                                        gint *pix_width,
+                                        gint *pix_height);
+void xfdesktop_icon_load_tooltip_pixbuf_async(XfdesktopIcon *icon,
                                               gint width,
-                                              gint height);
+                                              gint height,
+                                              GCancellable *cancellable,
+                                              GAsyncReadyCallback callback,
+                                              gpointer user_data);
+GdkPixbuf *xfdesktop_icon_load_tooltip_pixbuf_finish(XfdesktopIcon *icon,
+                                                     GAsyncResult *result,
+                                                     GError **error);
 const gchar *xfdesktop_icon_peek_tooltip(XfdesktopIcon *icon);
 
 /* returns a unique identifier for the icon, free when done using it */
@@ -123,7 +155,6 @@ void xfdesktop_icon_set_thumbnail_file(XfdesktopIcon *icon, GFile *file);
 void xfdesktop_icon_delete_thumbnail(XfdesktopIcon *icon);
 
 void xfdesktop_icon_invalidate_regular_pixbuf(XfdesktopIcon *icon);
-void xfdesktop_icon_invalidate_tooltip_pixbuf(XfdesktopIcon *icon);
 void xfdesktop_icon_invalidate_pixbuf(XfdesktopIcon *icon);
 
 /*< signal triggers >*/
@@ -71,19 +71,39 @@ struct _XfdesktopRegularFileIconPrivate
     GdkScreen *gscreen;
     XfdesktopFileIconManager *fmanager;
     gboolean show_thumbnails;
+
+    /* image being decoded in the background, and what it's for */
+    GCancellable *load_cancellable;
+    GIcon *load_gicon;
+    gint load_width;
+    gint load_height;
+    gint load_scale;
+    guint load_opacity;
+    GdkPixbuf *loaded_pix;
+
+    /* a folder's cover image, looked up once */
+    GFile *folder_cover;
+    GCancellable *folder_cover_cancellable;
+    gboolean folder_cover_resolved;
 };
 
 static void xfdesktop_regular_file_icon_finalize(GObject *obj);
 
 static void xfdesktop_regular_file_icon_set_thumbnail_file(XfdesktopIcon *icon, GFile *file);
 static void xfdesktop_regular_file_icon_delete_thumbnail_file(XfdesktopIcon *icon);
+static void xfdesktop_regular_file_icon_cancel_load(XfdesktopRegularFileIcon *icon);
 
 static GdkPixbuf *xfdesktop_regular_file_icon_peek_pixbuf(XfdesktopIcon *icon,
-                                                          gint width, gint height);
+                                                          gint width, gint height,
+                                                          gint scale);
 static const gchar *xfdesktop_regular_file_icon_peek_label(XfdesktopIcon *icon);
 static gchar *xfdesktop_regular_file_icon_get_identifier(XfdesktopIcon *icon);
-static GdkPixbuf *xfdesktop_regular_file_icon_peek_tooltip_pixbuf(XfdesktopIcon *icon,
-                                                                  gint width, gint height);
+static void xfdesktop_regular_file_icon_load_tooltip_pixbuf_async(XfdesktopIcon *icon,
+                                                                  gint width,
+                                                                  gint height,
+                                                                  GCancellable *cancellable,
+                                                                  GAsyncReadyCallback callback,
+                                                                  gpointer user_data);
 static const gchar *xfdesktop_regular_file_icon_peek_tooltip(XfdesktopIcon *icon);
 static GdkDragAction xfdesktop_regular_file_icon_get_allowed_drag_actions(XfdesktopIcon *icon);
 static GdkDragAction xfdesktop_regular_file_icon_get_allowed_drop_actions(XfdesktopIcon *icon,
@@ -128,7 +148,7 @@ xfdesktop_regular_file_icon_class_init(XfdesktopRegularFileIconClass *klass)
     icon_class->peek_pixbuf = xfdesktop_regular_file_icon_peek_pixbuf;
     icon_class->peek_label = xfdesktop_regular_file_icon_peek_label;
     icon_class->get_identifier = xfdesktop_regular_file_icon_get_identifier;
-    icon_class->peek_tooltip_pixbuf = xfdesktop_regular_file_icon_peek_tooltip_pixbuf;
+    icon_class->load_tooltip_pixbuf_async = xfdesktop_regular_file_icon_load_tooltip_pixbuf_async;
     icon_class->peek_tooltip = xfdesktop_regular_file_icon_peek_tooltip;
     icon_class->get_allowed_drag_actions = xfdesktop_regular_file_icon_get_allowed_drag_actions;
     icon_class->get_allowed_drop_actions = xfdesktop_regular_file_icon_get_allowed_drop_actions;
@@ -163,6 +183,11 @@ xfdesktop_regular_file_icon_finalize(GObject *obj)
     g_signal_handlers_disconnect_by_func(G_OBJECT(itheme),
                                          G_CALLBACK(xfdesktop_icon_invalidate_pixbuf),
                                          icon);
+
+    xfdesktop_regular_file_icon_cancel_load(icon);
+
+    if(icon->priv->folder_cover)
+        g_object_unref(icon->priv->folder_cover);
     
     if(icon->priv->file_info)
         g_object_unref(icon->priv->file_info);
@@ -218,6 +243,7 @@ xfdesktop_regular_file_icon_delete_thumbnail_file(XfdesktopIcon *icon)
         file_icon->priv->thumbnail_file = NULL;
     }
 
+    xfdesktop_regular_file_icon_cancel_load(file_icon);
     xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(icon));
 
     xfdesktop_icon_invalidate_pixbuf(icon);
@@ -239,6 +265,7 @@ xfdesktop_regular_file_icon_set_thumbnail_file(XfdesktopIcon *icon, GFile *file)
 
     file_icon->priv->thumbnail_file = file;
 
+    xfdesktop_regular_file_icon_cancel_load(file_icon);
     xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(icon));
 
     xfdesktop_icon_invalidate_pixbuf(icon);
@@ -266,6 +293,7 @@ cb_show_thumbnails_notify(GObject *gobject,
     if(regular_file_icon->priv->show_thumbnails != show_thumbnails) {
         XF_DEBUG("show-thumbnails changed! now: %s", show_thumbnails ? "TRUE" : "FALSE");
         regular_file_icon->priv->show_thumbnails = show_thumbnails;
+        xfdesktop_regular_file_icon_cancel_load(regular_file_icon);
         xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(regular_file_icon));
         xfdesktop_icon_invalidate_pixbuf(XFDESKTOP_ICON(regular_file_icon));
         xfdesktop_icon_pixbuf_changed(XFDESKTOP_ICON(regular_file_icon));
@@ -273,93 +301,147 @@ cb_show_thumbnails_notify(GObject *gobject,
 }
 
 
-/* builds a folder/file path and then tests if that file is a valid image.
- * returns the file location if it does, NULL if it doesn't */
-static gchar *
-xfdesktop_check_file_is_valid(const gchar *folder, const gchar *file)
+/* So much for standards; in order of preference, matched ignoring case */
+static const gchar *folder_cover_names[] = {
+    "folder.jpg",
+    "folder.jpeg",
+    "cover.jpg",
+    "cover.jpeg",
+    "albumart.jpg",
+    "albumart.jpeg",
+    "fanart.jpg",
+};
+
+static gint
+xfdesktop_folder_cover_priority(const gchar *name)
 {
-    gchar *path = g_strconcat(folder, "/", file, NULL);
+    guint i;
 
-    if(gdk_pixbuf_get_file_info(path, NULL, NULL) == NULL) {
-        g_free(path);
-        path = NULL;
+    for(i = 0; i < G_N_ELEMENTS(folder_cover_names); ++i) {
+        if(!g_ascii_strcasecmp(name, folder_cover_names[i]))
+            return i;
     }
 
-    return path;
+    return -1;
 }
 
-static gchar *
-xfdesktop_load_icon_location_from_folder(XfdesktopFileIcon *icon)
+/* Reads the folder once, picks the most preferred cover image name and
+ * only then checks that it's really an image. */
+static void
+xfdesktop_folder_cover_thread(GTask *task,
+                              gpointer source_object,
+                              gpointer task_data,
+                              GCancellable *cancellable)
 {
-    gchar *icon_file = g_file_get_path(xfdesktop_file_icon_peek_file(icon));
-    gchar *path;
-
-    g_return_val_if_fail(icon_file, NULL);
-
-    /* So much for standards */
-    path = xfdesktop_check_file_is_valid(icon_file, "Folder.jpg");
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "folder.jpg");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "Folder.JPG");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "folder.JPG");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "folder.jpeg");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "folder.JPEG");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "Folder.JPEG");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "Folder.jpeg");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "Cover.jpg");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "cover.jpg");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "Cover.jpeg");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "cover.jpeg");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "albumart.jpg");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "albumart.jpeg");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "fanart.jpg");
-    }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "Fanart.jpg");
+    const gchar *folder = task_data;
+    gchar *candidates[G_N_ELEMENTS(folder_cover_names)] = { NULL, };
+    gchar *path = NULL;
+    const gchar *name;
+    GDir *dir;
+    guint i;
+
+    dir = g_dir_open(folder, 0, NULL);
+    if(!dir) {
+        g_task_return_pointer(task, NULL, NULL);
+        return;
     }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "fanart.JPG");
+
+    while((name = g_dir_read_name(dir))) {
+        gint priority = xfdesktop_folder_cover_priority(name);
+        if(priority >= 0 && !candidates[priority])
+            candidates[priority] = g_build_filename(folder, name, NULL);
     }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "Fanart.JPG");
+    g_dir_close(dir);
+
+    for(i = 0; i < G_N_ELEMENTS(candidates); ++i) {
+        if(!path && candidates[i]
+           && !g_cancellable_is_cancelled(cancellable)
+           && gdk_pixbuf_get_file_info(candidates[i], NULL, NULL))
+        {
+            path = candidates[i];
+            candidates[i] = NULL;
+        }
+        g_free(candidates[i]);
     }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "FANART.JPG");
+
+    /* the file *should* already be a thumbnail */
+    g_task_return_pointer(task, path, g_free);
+}
+
+static void
+xfdesktop_folder_cover_resolved(GObject *source_object,
+                                GAsyncResult *result,
+                                gpointer user_data)
+{
+    XfdesktopRegularFileIcon *regular_icon = XFDESKTOP_REGULAR_FILE_ICON(source_object);
+    gchar *path;
+    GError *error = NULL;
+
+    path = g_task_propagate_pointer(G_TASK(result), &error);
+    if(error) {
+        /* the folder changed again in the meantime */
+        g_error_free(error);
+        return;
     }
-    if(path == NULL) {
-        path = xfdesktop_check_file_is_valid(icon_file, "FANART.jpg");
+
+    g_object_unref(regular_icon->priv->folder_cover_cancellable);
+    regular_icon->priv->folder_cover_cancellable = NULL;
+    regular_icon->priv->folder_cover_resolved = TRUE;
+
+    if(!path)
+        return;
+
+    XF_DEBUG("found folder cover %s", path);
+
+    regular_icon->priv->folder_cover = g_file_new_for_path(path);
+    g_free(path);
+
+    xfdesktop_regular_file_icon_cancel_load(regular_icon);
+    xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(regular_icon));
+    xfdesktop_icon_invalidate_pixbuf(XFDESKTOP_ICON(regular_icon));
+    xfdesktop_icon_pixbuf_changed(XFDESKTOP_ICON(regular_icon));
+}
+
+/* Returns the folder's cover image if it's already known; otherwise
+ * starts looking for one in the background and returns NULL, the icon
+ * gets updated if one turns up. */
+static GFile *
+xfdesktop_regular_file_icon_peek_folder_cover(XfdesktopRegularFileIcon *regular_icon)
+{
+    GTask *task;
+
+    if(regular_icon->priv->folder_cover_resolved)
+        return regular_icon->priv->folder_cover;
+
+    if(regular_icon->priv->folder_cover_cancellable)
+        return NULL;
+
+    regular_icon->priv->folder_cover_cancellable = g_cancellable_new();
+
+    task = g_task_new(regular_icon, regular_icon->priv->folder_cover_cancellable,
+                      xfdesktop_folder_cover_resolved, NULL);
+    g_task_set_task_data(task, g_file_get_path(regular_icon->priv->file), g_free);
+    g_task_run_in_thread(task, xfdesktop_folder_cover_thread);
+    g_object_unref(task);
+
+    return NULL;
+}
+
+static void
+xfdesktop_regular_file_icon_forget_folder_cover(XfdesktopRegularFileIcon *regular_icon)
+{
+    if(regular_icon->priv->folder_cover_cancellable) {
+        g_cancellable_cancel(regular_icon->priv->folder_cover_cancellable);
+        g_object_unref(regular_icon->priv->folder_cover_cancellable);
+        regular_icon->priv->folder_cover_cancellable = NULL;
     }
 
-    g_free(icon_file);
+    if(regular_icon->priv->folder_cover) {
+        g_object_unref(regular_icon->priv->folder_cover);
+        regular_icon->priv->folder_cover = NULL;
+    }
 
-    /* the file *should* already be a thumbnail */
-    return path;
+    regular_icon->priv->folder_cover_resolved = FALSE;
 }
 
 static GIcon *
@@ -465,17 +547,14 @@ xfdesktop_regular_file_icon_load_icon(XfdesktopIcon *icon)
 
     } else if(g_file_info_get_file_type(regular_icon->priv->file_info) == G_FILE_TYPE_DIRECTORY) {
         /* Try to load a thumbnail from the standard folder image locations */
-        gchar *thumbnail_file = NULL;
+        GFile *cover = NULL;
 
         if(regular_icon->priv->show_thumbnails)
-            thumbnail_file = xfdesktop_load_icon_location_from_folder(file_icon);
+            cover = xfdesktop_regular_file_icon_peek_folder_cover(regular_icon);
 
-        if(thumbnail_file) {
-            /* If there's a folder thumbnail, use it */
-            regular_icon->priv->thumbnail_file = g_file_new_for_path(thumbnail_file);
-            gicon = g_file_icon_new(regular_icon->priv->thumbnail_file);
-            g_free(thumbnail_file);
-        }
+        /* If there's a folder thumbnail, use it */
+        if(cover)
+            gicon = g_file_icon_new(cover);
 
     } else {
         /* If we have a thumbnail then they are enabled, use it. */
@@ -547,12 +626,96 @@ xfdesktop_regular_file_icon_load_icon(XfdesktopIcon *icon)
     return gicon;
 }
 
+static void
+xfdesktop_regular_file_icon_cancel_load(XfdesktopRegularFileIcon *icon)
+{
+    if(icon->priv->load_cancellable) {
+        g_cancellable_cancel(icon->priv->load_cancellable);
+        g_object_unref(icon->priv->load_cancellable);
+        icon->priv->load_cancellable = NULL;
+    }
+
+    if(icon->priv->load_gicon) {
+        g_object_unref(icon->priv->load_gicon);
+        icon->priv->load_gicon = NULL;
+    }
+
+    if(icon->priv->loaded_pix) {
+        g_object_unref(icon->priv->loaded_pix);
+        icon->priv->loaded_pix = NULL;
+    }
+}
+
+static void
+xfdesktop_regular_file_icon_image_loaded(GObject *source_object,
+                                         GAsyncResult *result,
+                                         gpointer user_data)
+{
+    XfdesktopRegularFileIcon *regular_icon;
+    GdkPixbuf *pix;
+    GError *error = NULL;
+
+    pix = xfdesktop_file_utils_get_icon_finish(result, &error);
+
+    /* cancelled loads may belong to icons that no longer exist */
+    if(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        g_error_free(error);
+        return;
+    }
+
+    regular_icon = XFDESKTOP_REGULAR_FILE_ICON(user_data);
+
+    if(error) {
+        g_warning("Unable to load the icon for %s: %s",
+                  regular_icon->priv->display_name, error->message);
+        g_error_free(error);
+    }
+
+    g_object_unref(regular_icon->priv->load_cancellable);
+    regular_icon->priv->load_cancellable = NULL;
+    regular_icon->priv->loaded_pix = pix;
+
+    /* swap the placeholder for the real thing */
+    xfdesktop_icon_invalidate_pixbuf(XFDESKTOP_ICON(regular_icon));
+    xfdesktop_icon_pixbuf_changed(XFDESKTOP_ICON(regular_icon));
+}
+
+/* the generic icon for the file's type, with @gicon's emblems */
+static GdkPixbuf *
+xfdesktop_regular_file_icon_get_placeholder(XfdesktopRegularFileIcon *regular_icon,
+                                            GIcon *gicon,
+                                            gint width, gint height,
+                                            gint scale)
+{
+    GIcon *type_icon, *placeholder;
+    GdkPixbuf *pix;
+    GList *l;
+
+    type_icon = g_file_info_get_icon(regular_icon->priv->file_info);
+    if(!type_icon)
+        return xfdesktop_file_utils_get_fallback_icon(MIN(width, height) * scale);
+
+    placeholder = g_emblemed_icon_new(type_icon, NULL);
+    if(G_IS_EMBLEMED_ICON(gicon)) {
+        for(l = g_emblemed_icon_get_emblems(G_EMBLEMED_ICON(gicon)); l; l = l->next)
+            g_emblemed_icon_add_emblem(G_EMBLEMED_ICON(placeholder), l->data);
+    }
+
+    pix = xfdesktop_file_utils_get_icon_for_scale(placeholder, width, height, scale,
+                                                  regular_icon->priv->pix_opacity);
+
+    g_object_unref(placeholder);
+
+    return pix;
+}
+
 static GdkPixbuf *
 xfdesktop_regular_file_icon_peek_pixbuf(XfdesktopIcon *icon,
-                                        gint width, gint height)
+                                        gint width, gint height,
+                                        gint scale)
 {
     XfdesktopRegularFileIcon *regular_icon = XFDESKTOP_REGULAR_FILE_ICON(icon);
-    GIcon *gicon = NULL;
+    GIcon *gicon = NULL, *base_icon;
     GdkPixbuf *pix = NULL;
 
     if(!xfdesktop_file_icon_has_gicon(XFDESKTOP_FILE_ICON(icon)))
@@ -560,27 +723,96 @@ xfdesktop_regular_file_icon_peek_pixbuf(XfdesktopIcon *icon,
     else
         g_object_get(XFDESKTOP_FILE_ICON(icon), "gicon", &gicon, NULL);
 
-    pix = xfdesktop_file_utils_get_icon(gicon, width, height,
-                                        regular_icon->priv->pix_opacity);
+    base_icon = G_IS_EMBLEMED_ICON(gicon)
+                ? g_emblemed_icon_get_icon(G_EMBLEMED_ICON(gicon))
+                : gicon;
 
-    return pix;
+    /* themed icons are cheap, everything else has to be read from disk
+     * and decoded */
+    if(!base_icon || G_IS_THEMED_ICON(base_icon)) {
+        pix = xfdesktop_file_utils_get_icon_for_scale(gicon, width, height, scale,
+                                                      regular_icon->priv->pix_opacity);
+        return pix;
+    }
+
+    if(regular_icon->priv->load_gicon
+       && regular_icon->priv->load_width == width
+       && regular_icon->priv->load_height == height
+       && regular_icon->priv->load_scale == scale
+       && regular_icon->priv->load_opacity == regular_icon->priv->pix_opacity
+       && g_icon_equal(regular_icon->priv->load_gicon, gicon))
+    {
+        if(regular_icon->priv->loaded_pix)
+            return g_object_ref(regular_icon->priv->loaded_pix);
+    } else {
+        xfdesktop_regular_file_icon_cancel_load(regular_icon);
+
+        regular_icon->priv->load_cancellable = g_cancellable_new();
+        regular_icon->priv->load_gicon = g_object_ref(gicon);
+        regular_icon->priv->load_width = width;
+        regular_icon->priv->load_height = height;
+        regular_icon->priv->load_scale = scale;
+        regular_icon->priv->load_opacity = regular_icon->priv->pix_opacity;
+
+        xfdesktop_file_utils_get_icon_async(gicon, width, height, scale,
+                                            regular_icon->priv->pix_opacity,
+                                            regular_icon->priv->load_cancellable,
+                                            xfdesktop_regular_file_icon_image_loaded,
+                                            regular_icon);
+    }
+
+    /* still loading */
+    return xfdesktop_regular_file_icon_get_placeholder(regular_icon, gicon,
+                                                       width, height, scale);
 }
 
-static GdkPixbuf *
-xfdesktop_regular_file_icon_peek_tooltip_pixbuf(XfdesktopIcon *icon,
-                                                gint width, gint height)
+static void
+xfdesktop_regular_file_icon_tooltip_pixbuf_loaded(GObject *source_object,
+                                                  GAsyncResult *result,
+                                                  gpointer user_data)
+{
+    GTask *task = G_TASK(user_data);
+    GdkPixbuf *tooltip_pix;
+    GError *error = NULL;
+
+    tooltip_pix = xfdesktop_file_utils_get_icon_finish(result, &error);
+    if(error)
+        g_task_return_error(task, error);
+    else
+        g_task_return_pointer(task, tooltip_pix, tooltip_pix ? g_object_unref : NULL);
+
+    g_object_unref(task);
+}
+
+/* tooltips are big enough that the preview is often a full size image or
+ * a thumbnail, so decode it without blocking the pointer */
+static void
+xfdesktop_regular_file_icon_load_tooltip_pixbuf_async(XfdesktopIcon *icon,
+                                                      gint width,
+                                                      gint height,
+                                                      GCancellable *cancellable,
+                                                      GAsyncReadyCallback callback,
+                                                      gpointer user_data)
 {
     GIcon *gicon = NULL;
-    GdkPixbuf *tooltip_pix = NULL;
+    GTask *task;
+
+    task = g_task_new(icon, cancellable, callback, user_data);
 
     if(!xfdesktop_file_icon_has_gicon(XFDESKTOP_FILE_ICON(icon)))
         gicon = xfdesktop_regular_file_icon_load_icon(icon);
     else
         g_object_get(XFDESKTOP_FILE_ICON(icon), "gicon", &gicon, NULL);
 
-    tooltip_pix = xfdesktop_file_utils_get_icon(gicon, width, height, 100);
+    if(!gicon) {
+        g_task_return_pointer(task, NULL, NULL);
+        g_object_unref(task);
+        return;
+    }
 
-    return tooltip_pix;
+    xfdesktop_file_utils_get_icon_async(gicon, width, height, 1, 100, cancellable,
+                                        xfdesktop_regular_file_icon_tooltip_pixbuf_loaded,
+                                        task);
 }
 
 static const gchar *
@@ -872,8 +1104,20 @@ xfdesktop_regular_file_icon_peek_file_info(XfdesktopFileIcon *icon)
 static GFileInfo *
 xfdesktop_regular_file_icon_peek_filesystem_info(XfdesktopFileIcon *icon)
 {
+    XfdesktopRegularFileIcon *regular_file_icon;
+
     g_return_val_if_fail(XFDESKTOP_IS_REGULAR_FILE_ICON(icon), NULL);
-    return XFDESKTOP_REGULAR_FILE_ICON(icon)->priv->filesystem_info;
+    regular_file_icon = XFDESKTOP_REGULAR_FILE_ICON(icon);
+
+    /* only menus and property pages want this, so don't stat every
+     * file system for every icon up front */
+    if(!regular_file_icon->priv->filesystem_info) {
+        regular_file_icon->priv->filesystem_info = g_file_query_filesystem_info(regular_file_icon->priv->file,
+                                                                                XFDESKTOP_FILESYSTEM_INFO_NAMESPACE,
+                                                                                NULL, NULL);
+    }
+
+    return regular_file_icon->priv->filesystem_info;
 }
 
 static GFile *
@@ -902,12 +1146,11 @@ xfdesktop_regular_file_icon_update_file_info(XfdesktopFileIcon *icon,
 
     regular_file_icon->priv->file_info = g_object_ref(info);
 
-    if(regular_file_icon->priv->filesystem_info)
+    /* looked up again when it's needed */
+    if(regular_file_icon->priv->filesystem_info) {
         g_object_unref(regular_file_icon->priv->filesystem_info);
-
-    regular_file_icon->priv->filesystem_info = g_file_query_filesystem_info(regular_file_icon->priv->file,
-                                                                            XFDESKTOP_FILESYSTEM_INFO_NAMESPACE,
-                                                                            NULL, NULL);
+        regular_file_icon->priv->filesystem_info = NULL;
+    }
 
     /* get both, old and new display name */
     old_display_name = regular_file_icon->priv->display_name;
@@ -932,6 +1175,7 @@ xfdesktop_regular_file_icon_update_file_info(XfdesktopFileIcon *icon,
     regular_file_icon->priv->tooltip = NULL;
     
     /* not really easy to check if this changed or not, so just invalidate it */
+    xfdesktop_regular_file_icon_cancel_load(regular_file_icon);
     xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(icon));
     xfdesktop_icon_invalidate_pixbuf(XFDESKTOP_ICON(icon));
     xfdesktop_icon_pixbuf_changed(XFDESKTOP_ICON(icon));
@@ -945,35 +1189,50 @@ cb_folder_contents_changed(GFileMonitor     *monitor,
                            gpointer          user_data)
 {
     XfdesktopRegularFileIcon *regular_file_icon;
-    gchar *thumbnail_file = NULL;
+    gchar *name, *other_name = NULL;
+    gboolean is_cover;
 
     if(!user_data || !XFDESKTOP_IS_REGULAR_FILE_ICON(user_data))
         return;
 
     regular_file_icon = XFDESKTOP_REGULAR_FILE_ICON(user_data);
 
-    /* not showing thumbnails */
-    if(!regular_file_icon->priv->show_thumbnails)
-        return;
-
-    /* Already has a thumbnail */
-    if(regular_file_icon->priv->thumbnail_file != NULL)
-        return;
-
     switch(event) {
         case G_FILE_MONITOR_EVENT_CREATED:
-                thumbnail_file = xfdesktop_load_icon_location_from_folder(XFDESKTOP_FILE_ICON(regular_file_icon));
-                if(thumbnail_file) {
-                    GFile *thumbnail = g_file_new_for_path(thumbnail_file);
-                    /* found a thumbnail file, apply it */
-                    xfdesktop_regular_file_icon_set_thumbnail_file(XFDESKTOP_ICON(regular_file_icon),
-                                                                   thumbnail);
-                    g_free(thumbnail_file);
-                }
+        case G_FILE_MONITOR_EVENT_DELETED:
+        case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+        case G_FILE_MONITOR_EVENT_MOVED:
+        case G_FILE_MONITOR_EVENT_RENAMED:
+        case G_FILE_MONITOR_EVENT_MOVED_IN:
+        case G_FILE_MONITOR_EVENT_MOVED_OUT:
             break;
         default:
-            break;
+            return;
     }
+
+    /* only a cover image coming or going makes the cached one stale */
+    name = g_file_get_basename(file);
+    if(other_file)
+        other_name = g_file_get_basename(other_file);
+    is_cover = xfdesktop_folder_cover_priority(name) >= 0
+               || (other_name && xfdesktop_folder_cover_priority(other_name) >= 0);
+    g_free(other_name);
+    g_free(name);
+
+    if(!is_cover)
+        return;
+
+    xfdesktop_regular_file_icon_forget_folder_cover(regular_file_icon);
+
+    /* not showing thumbnails, it gets looked up when they're turned on */
+    if(!regular_file_icon->priv->show_thumbnails)
+        return;
+
+    /* look again, and drop any cover we had in case it's gone */
+    xfdesktop_regular_file_icon_cancel_load(regular_file_icon);
+    xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(regular_file_icon));
+    xfdesktop_icon_invalidate_pixbuf(XFDESKTOP_ICON(regular_file_icon));
+    xfdesktop_icon_pixbuf_changed(XFDESKTOP_ICON(regular_file_icon));
 }
 
 /* public API */
@@ -999,16 +1258,8 @@ xfdesktop_regular_file_icon_new(GFile *file,
     regular_file_icon->priv->display_name = xfdesktop_file_utils_get_display_name(file, 
                                                                                   file_info);
 
-    /* query file system information from GIO */
-    regular_file_icon->priv->filesystem_info = g_file_query_filesystem_info(regular_file_icon->priv->file,
-                                                                            XFDESKTOP_FILESYSTEM_INFO_NAMESPACE,
-                                                                            NULL, NULL);
-
-    /* query file information from GIO */
-    regular_file_icon->priv->file_info = g_file_query_info(regular_file_icon->priv->file,
-                                                           XFDESKTOP_FILE_INFO_NAMESPACE,
-                                                           G_FILE_QUERY_INFO_NONE,
-                                                           NULL, NULL);
+    /* the file system information is queried when it's first needed,
+     * and @file_info already has everything in XFDESKTOP_FILE_INFO_NAMESPACE */
 
     regular_file_icon->priv->gscreen = screen;
 
@@ -69,7 +69,8 @@ struct _XfdesktopSpecialFileIconPrivate
 static void xfdesktop_special_file_icon_finalize(GObject *obj);
 
 static GdkPixbuf *xfdesktop_special_file_icon_peek_pixbuf(XfdesktopIcon *icon,
-                                                          gint width, gint height);
+                                                          gint width, gint height,
+                                                          gint scale);
 static const gchar *xfdesktop_special_file_icon_peek_label(XfdesktopIcon *icon);
 static gchar *xfdesktop_special_file_icon_get_identifier(XfdesktopIcon *icon);
 static GdkPixbuf *xfdesktop_special_file_icon_peek_tooltip_pixbuf(XfdesktopIcon *icon,
@@ -253,7 +254,8 @@ xfdesktop_special_file_icon_load_icon(XfdesktopIcon *icon)
 
 static GdkPixbuf *
 xfdesktop_special_file_icon_peek_pixbuf(XfdesktopIcon *icon,
-                                        gint width, gint height)
+                                        gint width, gint height,
+                                        gint scale)
 {
     GIcon *gicon = NULL;
     GdkPixbuf *pix = NULL;
@@ -263,7 +265,7 @@ xfdesktop_special_file_icon_peek_pixbuf(XfdesktopIcon *icon,
     else
         g_object_get(XFDESKTOP_FILE_ICON(icon), "gicon", &gicon, NULL);
 
-    pix = xfdesktop_file_utils_get_icon(gicon, height, height, 100);
+    pix = xfdesktop_file_utils_get_icon_for_scale(gicon, height, height, scale, 100);
 
     return pix;
 }
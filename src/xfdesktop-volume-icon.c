@@ -75,7 +75,8 @@ struct _XfdesktopVolumeIconPrivate
 static void xfdesktop_volume_icon_finalize(GObject *obj);
 
 static GdkPixbuf *xfdesktop_volume_icon_peek_pixbuf(XfdesktopIcon *icon,
-                                                    gint width, gint height);
+                                                    gint width, gint height,
+                                                    gint scale);
 static const gchar *xfdesktop_volume_icon_peek_label(XfdesktopIcon *icon);
 static gchar *xfdesktop_volume_icon_get_identifier(XfdesktopIcon *icon);
 static GdkPixbuf *xfdesktop_volume_icon_peek_tooltip_pixbuf(XfdesktopIcon *icon,
@@ -265,7 +266,8 @@ xfdesktop_volume_icon_load_icon(XfdesktopIcon *icon)
 
 static GdkPixbuf *
 xfdesktop_volume_icon_peek_pixbuf(XfdesktopIcon *icon,
-                                  gint width, gint height)
+                                  gint width, gint height,
+                                  gint scale)
 {
     gint opacity = 100;
     GIcon *gicon = NULL;
@@ -282,7 +284,7 @@ xfdesktop_volume_icon_peek_pixbuf(XfdesktopIcon *icon,
     if(!xfdesktop_volume_icon_is_mounted(icon))
         opacity = 50;
 
-    pix = xfdesktop_file_utils_get_icon(gicon, height, height, opacity);
+    pix = xfdesktop_file_utils_get_icon_for_scale(gicon, height, height, scale, opacity);
 
     return pix;
 }
@@ -41,7 +41,8 @@ struct _XfdesktopWindowIconPrivate
 static void xfdesktop_window_icon_finalize(GObject *obj);
 
 static GdkPixbuf *xfdesktop_window_icon_peek_pixbuf(XfdesktopIcon *icon,
-                                                   gint width, gint height);
+                                                   gint width, gint height,
+                                                   gint scale);
 static const gchar *xfdesktop_window_icon_peek_label(XfdesktopIcon *icon);
 static gchar *xfdesktop_window_icon_get_identifier(XfdesktopIcon *icon);
 
@@ -139,15 +140,17 @@ xfdesktop_window_icon_changed_cb(WnckWindow *window,
 
 static GdkPixbuf *
 xfdesktop_window_icon_peek_pixbuf(XfdesktopIcon *icon,
-                                 gint width, gint height)
+                                 gint width, gint height,
+                                 gint scale)
 {
     XfdesktopWindowIcon *window_icon = XFDESKTOP_WINDOW_ICON(icon);
     GdkPixbuf *pix = NULL;
 
     pix = wnck_window_get_icon(window_icon->priv->window);
     if(pix) {
-        if(gdk_pixbuf_get_height(pix) != height) {
-            pix = gdk_pixbuf_scale_simple(pix, height, height, GDK_INTERP_BILINEAR);
+        if(gdk_pixbuf_get_height(pix) != height * scale) {
+            pix = gdk_pixbuf_scale_simple(pix, height * scale, height * scale,
+                                          GDK_INTERP_BILINEAR);
         } else
             g_object_ref(G_OBJECT(pix));
     }